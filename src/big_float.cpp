@@ -0,0 +1,734 @@
+#include "big_float.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace {
+// Newton for Log starts from a double
+constexpr uint64_t kDoubleBits = 48;
+
+// Decimal exponents beyond this would overflow the binary exponent
+constexpr uint64_t kMaxDecimalExponent = 1'000'000'000'000'000'000;
+
+// FromString applies 10^exp exactly up to precision plus this many per char
+// of the digits. Past that, for exp > 0 the odd part 5^exp of the value is
+// longer than the precision, and for exp < 0 5^-exp can't divide the digits,
+// so the value is neither representable nor a tie.
+constexpr uint64_t kMaxExactExponentPerChar = 4;
+
+// Exp saturates to 2^this above about this many times ln 2 and to 0 below
+// the negative, the result exponents stay far from the int64 limits
+constexpr int64_t kMaxExpExponent = int64_t{1} << 62;
+
+// Extra bits for the intermediate results of the transcendental functions
+uint64_t WorkPrecision(uint64_t precision) {
+  return precision + 32 + 2 * std::bit_width(precision);
+}
+
+BigInt Abs(const BigInt& val) {
+  return (val < 0) ? -val : val;
+}
+
+int Signum(const BigInt& val) {
+  return (val > 0) - (val < 0);
+}
+
+// 10^exp rounded to precision, by squaring
+BigFloat PowerOfTen(uint64_t exp, uint64_t precision) {
+  BigFloat base(10, precision);
+  BigFloat res(1, precision);
+  for (; exp > 0; exp >>= 1) {
+    if (exp & 1) {
+      res *= base;
+    }
+    if (exp > 1) {
+      base *= base;
+    }
+  }
+  return res;
+}
+
+// val 10^exp at work bits, widened by its error bound to [lo, hi]. Each
+// rounded operation is off by 2^-work relative, the powering takes two per
+// exponent bit.
+std::pair<BigFloat, BigFloat> ScaleByPowerOfTen(BigFloat val, int64_t exp,
+                                                uint64_t work) {
+  auto abs_exp = static_cast<uint64_t>(exp < 0 ? -exp : exp);
+  val.SetPrecision(work);
+  if (exp >= 0) {
+    val *= PowerOfTen(abs_exp, work);
+  } else {
+    val /= PowerOfTen(abs_exp, work);
+  }
+
+  uint64_t err_ulps = 4 * std::bit_width(abs_exp) + 16;
+  int64_t top =
+      val.Exponent() + static_cast<int64_t>(val.Mantissa().BitLength());
+  BigFloat err(err_ulps, top - static_cast<int64_t>(work), 64);
+  BigFloat lo = val;
+  BigFloat hi = val;
+  lo.SetPrecision(work + 64);
+  hi.SetPrecision(work + 64);
+  lo -= err;
+  hi += err;
+  return {std::move(lo), std::move(hi)};
+}
+
+BigInt Power(BigInt base, uint64_t exp) {
+  BigInt res = 1;
+  for (; exp > 0; exp >>= 1) {
+    if (exp & 1) {
+      res *= base;
+    }
+    if (exp > 1) {
+      base *= base;
+    }
+  }
+  return res;
+}
+
+// floor(sqrt(n)): the root of the top half, then one Newton step from
+// above, so the precision doubles with every level
+BigInt ISqrt(const BigInt& n) {
+  uint64_t len = n.BitLength();
+
+  if (len <= 64) {
+    uint64_t val = n.ToUint64Saturating();
+    auto root = static_cast<uint64_t>(std::sqrt(static_cast<double>(val)));
+    while (static_cast<UInt128>(root) * root > val) {
+      --root;
+    }
+    while (static_cast<UInt128>(root + 1) * (root + 1) <= val) {
+      ++root;
+    }
+    return root;
+  }
+
+  uint64_t half_shift = len / 4;
+  BigInt root = (ISqrt(n >> (2 * half_shift)) + 1) << half_shift;
+
+  BigInt quot;
+  BigInt rem;
+  DivMod(quot, rem, n, root);
+  root += quot;
+  root >>= 1;
+
+  while (root * root > n) {
+    --root;
+  }
+  for (BigInt next = root + 1; next * next <= n; next = root + 1) {
+    root = std::move(next);
+  }
+  return root;
+}
+
+BigInt RoundToInteger(const BigFloat& val) {
+  if (val.Exponent() >= 0) {
+    return val.Mantissa() << static_cast<uint64_t>(val.Exponent());
+  }
+
+  auto shift = static_cast<uint64_t>(-val.Exponent());
+  return (val.Mantissa() + (BigInt(1) << (shift - 1))) >> shift;
+}
+
+// sum over n in [lo, hi) of a(n) / b(n) prod_{j = lo..n} p(j) / q(j) is
+// t / (b q). Leaves hold a(n) in t.
+struct SeriesSplit {
+  BigInt p;
+  BigInt q;
+  BigInt b;
+  BigInt t;
+};
+
+template <typename Term>
+SeriesSplit BinarySplit(const Term& term, uint64_t lo, uint64_t hi) {
+  if (hi - lo == 1) {
+    SeriesSplit leaf = term(lo);
+    leaf.t *= leaf.p;
+    return leaf;
+  }
+
+  uint64_t mid = lo + (hi - lo) / 2;
+  SeriesSplit left = BinarySplit(term, lo, mid);
+  SeriesSplit right = BinarySplit(term, mid, hi);
+
+  // t = b2 q2 t1 + b1 p1 t2
+  left.t *= right.b * right.q;
+  right.t *= left.b * left.p;
+  left.t += right.t;
+  left.p *= right.p;
+  left.q *= right.q;
+  left.b *= right.b;
+  return left;
+}
+
+BigFloat SeriesValue(const SeriesSplit& split, uint64_t precision) {
+  return BigFloat(split.t, precision) /
+         BigFloat(split.b * split.q, precision);
+}
+
+// exp(u / 2^k) for |u| < 2^k
+BigFloat ExpSeries(const BigInt& u, uint64_t k, uint64_t precision) {
+  // Terms until (|u| / 2^k)^n / n! drops below 2^-precision
+  auto shrink = static_cast<double>(k - u.BitLength());
+  uint64_t terms = 1;
+  for (double bits = 0; bits < precision + 2; ++terms) {
+    bits += shrink + std::log2(static_cast<double>(terms));
+  }
+
+  auto term = [&](uint64_t n) {
+    if (n == 0) {
+      return SeriesSplit{1, 1, 1, 1};
+    }
+    return SeriesSplit{u, BigInt(n) << k, 1, 1};
+  };
+
+  return SeriesValue(BinarySplit(term, 0, terms + 1), precision);
+}
+};  // namespace
+
+BigFloat::BigFloat(const BigInt& val, uint64_t precision)
+    : mantissa_(val), precision_(precision) {
+  Round();
+}
+
+BigFloat::BigFloat(BigInt mantissa, int64_t exponent, uint64_t precision)
+    : mantissa_(std::move(mantissa)),
+      exponent_(exponent),
+      precision_(precision) {
+  Round();
+}
+
+BigFloat BigFloat::FromDouble(double val, uint64_t precision) {
+  assert(std::isfinite(val));
+
+  int exp = 0;
+  double mantissa = std::frexp(val, &exp);
+  auto digits = std::numeric_limits<double>::digits;
+  return BigFloat(static_cast<int64_t>(std::ldexp(mantissa, digits)),
+                  exp - digits, precision);
+}
+
+// Both parts are exact before the single rounding division
+BigFloat BigFloat::FromRational(const BigRational& val, uint64_t precision) {
+  const BigInt& num = val.Numerator();
+  const BigInt& den = val.Denominator();
+
+  BigFloat res(num, 0, std::max<uint64_t>(num.BitLength(), 1));
+  res.precision_ = precision;
+  res /= BigFloat(den, 0, std::max<uint64_t>(den.BitLength(), 1));
+  return res;
+}
+
+// Small exponents are applied exactly. Past that 10^exp alone would dwarf
+// both the input and the result, so the value is computed with guard bits
+// and rounded once the error bound can't straddle a rounding boundary
+// (Ziv's strategy). Such values are never exactly representable or ties,
+// see kMaxExactExponentPerChar, so the loop ends.
+std::optional<BigFloat> BigFloat::FromString(std::string_view str,
+                                             uint64_t precision) {
+  int64_t exp = 0;
+
+  if (auto pos = str.find_first_of("eE"); pos != std::string_view::npos) {
+    auto parsed = BigInt::FromString(str.substr(pos + 1));
+    if (!parsed || Abs(*parsed) > kMaxDecimalExponent) {
+      return std::nullopt;
+    }
+    exp = *parsed->ToInt64();
+    str = str.substr(0, pos);
+  }
+
+  auto val = BigRational::FromString(str);
+  if (!val) {
+    return std::nullopt;
+  }
+
+  auto abs_exp = static_cast<uint64_t>(exp < 0 ? -exp : exp);
+  if (val->Numerator() == 0) {
+    return FromRational(*val, precision);
+  }
+
+  if (abs_exp <= precision + kMaxExactExponentPerChar * str.size()) {
+    BigInt scale = Power(10, abs_exp);
+    if (exp >= 0) {
+      *val *= BigRational(std::move(scale));
+    } else {
+      *val /= BigRational(std::move(scale));
+    }
+    return FromRational(*val, precision);
+  }
+
+  for (uint64_t guard = 64;; guard *= 2) {
+    uint64_t work = precision + guard;
+    auto [lo, hi] = ScaleByPowerOfTen(FromRational(*val, work), exp, work);
+    lo.SetPrecision(precision);
+    hi.SetPrecision(precision);
+
+    if (lo == hi) {
+      return lo;
+    }
+  }
+}
+
+void BigFloat::SetPrecision(uint64_t precision) {
+  precision_ = precision;
+  Round();
+}
+
+// The top 64 bits with a sticky lowest bit round once, correctly
+double BigFloat::ToDouble() const {
+  if (mantissa_ == 0) {
+    return 0.0;
+  }
+
+  BigInt abs = Abs(mantissa_);
+  int64_t exp = exponent_;
+  uint64_t len = abs.BitLength();
+
+  if (len > 64) {
+    uint64_t shift = len - 64;
+    BigInt top = abs >> shift;
+    if ((top << shift) != abs && !top.TestBit(0)) {
+      ++top;
+    }
+    abs = std::move(top);
+    exp += static_cast<int64_t>(shift);
+  }
+
+  constexpr int64_t kMaxShift = 1 << 16;
+  double res = std::ldexp(static_cast<double>(abs.ToUint64Saturating()),
+                          static_cast<int>(std::clamp(exp, -kMaxShift,
+                                                      kMaxShift)));
+  return (mantissa_ < 0) ? -res : res;
+}
+
+BigRational BigFloat::ToRational() const {
+  if (exponent_ >= 0) {
+    return BigRational(mantissa_ << static_cast<uint64_t>(exponent_));
+  }
+
+  BigRational res(mantissa_,
+                  BigInt(1) << static_cast<uint64_t>(-exponent_));
+  res.Normalize();
+  return res;
+}
+
+std::string BigFloat::ToString(std::size_t digits) const {
+  if (mantissa_ == 0) {
+    return "0";
+  }
+
+  if (digits == 0) {
+    digits = static_cast<std::size_t>(
+                 static_cast<double>(precision_) * std::log10(2.0)) +
+             1;
+  }
+
+  // Decimal exponent from the top bit, fixed up when off by one
+  int64_t top = exponent_ + static_cast<int64_t>(mantissa_.BitLength()) - 1;
+  auto exp10 = static_cast<int64_t>(
+      std::floor(static_cast<double>(top) * std::log10(2.0)));
+
+  // Bits far below the last digit only matter as a sticky bit, keeping
+  // them would make the decimal conversion as long as the mantissa
+  BigFloat trimmed = (mantissa_ < 0) ? -*this : *this;
+  auto keep_bits = static_cast<uint64_t>(static_cast<double>(digits) *
+                                         std::log2(10.0)) +
+                   64;
+  if (uint64_t len = mantissa_.BitLength(); len > keep_bits) {
+    BigInt kept = trimmed.mantissa_ >> (len - keep_bits);
+    if ((kept << (len - keep_bits)) != trimmed.mantissa_ && !kept.TestBit(0)) {
+      ++kept;
+    }
+    trimmed.mantissa_ = std::move(kept);
+    trimmed.exponent_ += static_cast<int64_t>(len - keep_bits);
+  }
+
+  // Scales up to keep_bits are applied exactly. Past that 10^scale is longer
+  // than both the digits and the trimmed mantissa, so the scaled value can't
+  // be a tie and the guard bits grow until its rounding is settled, as in
+  // FromString.
+  std::string scaled;
+  for (;;) {
+    int64_t scale = static_cast<int64_t>(digits) - 1 - exp10;
+    auto abs_scale = static_cast<uint64_t>(std::abs(scale));
+    if (abs_scale <= keep_bits) {
+      BigRational abs = trimmed.ToRational();
+      BigRational power(Power(10, abs_scale));
+      scaled = ((scale >= 0) ? abs * power : abs / power).ToDecimalString(0);
+    } else {
+      for (uint64_t guard = 64;; guard *= 2) {
+        auto [lo, hi] = ScaleByPowerOfTen(trimmed, scale, keep_bits + guard);
+        BigInt rounded = RoundToInteger(lo);
+        if (rounded == RoundToInteger(hi)) {
+          scaled = rounded.ToString();
+          break;
+        }
+      }
+    }
+
+    if (scaled.size() > digits) {
+      ++exp10;
+    } else if (scaled.size() < digits) {
+      --exp10;
+    } else {
+      break;
+    }
+  }
+
+  std::string res = (mantissa_ < 0) ? "-" : "";
+  res += scaled[0];
+  if (digits > 1) {
+    res += '.';
+    res.append(scaled, 1);
+  }
+  return res + "e" + std::to_string(exp10);
+}
+
+BigFloat& BigFloat::operator+=(const BigFloat& other) {
+  AddSigned(other, false);
+  return *this;
+}
+
+BigFloat& BigFloat::operator-=(const BigFloat& other) {
+  AddSigned(other, true);
+  return *this;
+}
+
+BigFloat& BigFloat::operator*=(const BigFloat& other) {
+  mantissa_ *= other.mantissa_;
+  exponent_ += other.exponent_;
+  Round();
+  return *this;
+}
+
+// The quotient gets at least precision + 3 bits, the remainder only
+// matters as the sticky bit
+BigFloat& BigFloat::operator/=(const BigFloat& other) {
+  assert(other.mantissa_ != 0);
+
+  if (mantissa_ == 0) {
+    return *this;
+  }
+
+  bool negative = (mantissa_ < 0) != (other.mantissa_ < 0);
+  BigInt num = Abs(mantissa_);
+  BigInt den = Abs(other.mantissa_);
+
+  int64_t shift = static_cast<int64_t>(precision_ + 3 + den.BitLength()) -
+                  static_cast<int64_t>(num.BitLength());
+  shift = std::max<int64_t>(shift, 0);
+  num <<= static_cast<uint64_t>(shift);
+
+  BigInt quot;
+  BigInt rem;
+  DivMod(quot, rem, num, den);
+
+  exponent_ = exponent_ - other.exponent_ - shift;
+  mantissa_ = negative ? -std::move(quot) : std::move(quot);
+  Round(rem != 0);
+  return *this;
+}
+
+BigFloat BigFloat::operator-() const {
+  BigFloat res = *this;
+  res.mantissa_ = -std::move(res.mantissa_);
+  return res;
+}
+
+std::strong_ordering BigFloat::operator<=>(const BigFloat& other) const {
+  int sign = Signum(mantissa_);
+  int other_sign = Signum(other.mantissa_);
+  if (sign != other_sign || sign == 0) {
+    return sign <=> other_sign;
+  }
+
+  int64_t top = exponent_ + static_cast<int64_t>(mantissa_.BitLength());
+  int64_t other_top =
+      other.exponent_ + static_cast<int64_t>(other.mantissa_.BitLength());
+  if (top != other_top) {
+    return (sign > 0) ? top <=> other_top : other_top <=> top;
+  }
+
+  // Same top bit, so aligning costs at most the mantissa lengths
+  int64_t low = std::min(exponent_, other.exponent_);
+  return (mantissa_ << static_cast<uint64_t>(exponent_ - low)) <=>
+         (other.mantissa_ << static_cast<uint64_t>(other.exponent_ - low));
+}
+
+bool BigFloat::operator==(const BigFloat& other) const {
+  return (*this <=> other) == std::strong_ordering::equal;
+}
+
+void BigFloat::Round(bool sticky) {
+  assert(precision_ > 0);
+
+  if (mantissa_ == 0) {
+    exponent_ = 0;
+    return;
+  }
+
+  uint64_t len = mantissa_.BitLength();
+  if (len <= precision_) {
+    assert(!sticky);
+    return;
+  }
+
+  uint64_t shift = len - precision_;
+  bool negative = (mantissa_ < 0);
+  BigInt abs = Abs(mantissa_);
+
+  // half is the highest dropped bit, sticky stands for all below it
+  BigInt kept = abs >> (shift - 1);
+  bool half = kept.TestBit(0);
+  sticky = sticky || (kept << (shift - 1)) != abs;
+  kept >>= 1;
+
+  if (half && (sticky || kept.TestBit(0))) {
+    ++kept;
+    if (kept.BitLength() > precision_) {
+      kept >>= 1;
+      ++shift;
+    }
+  }
+
+  exponent_ += static_cast<int64_t>(shift);
+  mantissa_ = negative ? -std::move(kept) : std::move(kept);
+}
+
+// An operand entirely below both the rounding position and the other
+// operand's lowest bit only decides the rounding direction, so it is
+// replaced by a single unit just under them and the alignment stays cheap.
+void BigFloat::AddSigned(const BigFloat& other, bool negate) {
+  if (other.mantissa_ == 0) {
+    return;
+  }
+
+  BigInt other_mantissa = negate ? -other.mantissa_ : other.mantissa_;
+  int64_t other_exponent = other.exponent_;
+
+  if (mantissa_ == 0) {
+    mantissa_ = std::move(other_mantissa);
+    exponent_ = other_exponent;
+    Round();
+    return;
+  }
+
+  int64_t top = exponent_ + static_cast<int64_t>(mantissa_.BitLength());
+  int64_t other_top =
+      other_exponent + static_cast<int64_t>(other_mantissa.BitLength());
+  int64_t floor = std::max(top, other_top) -
+                  static_cast<int64_t>(precision_) - 2;
+
+  if (other_top <= std::min(floor, exponent_)) {
+    other_mantissa = Signum(other_mantissa);
+    other_exponent = std::min(floor, exponent_) - 1;
+  } else if (top <= std::min(floor, other_exponent)) {
+    mantissa_ = Signum(mantissa_);
+    exponent_ = std::min(floor, other_exponent) - 1;
+  }
+
+  int64_t low = std::min(exponent_, other_exponent);
+  mantissa_ <<= static_cast<uint64_t>(exponent_ - low);
+  mantissa_ += other_mantissa << static_cast<uint64_t>(other_exponent - low);
+  exponent_ = low;
+  Round();
+}
+
+std::ostream& operator<<(std::ostream& stream, const BigFloat& val) {
+  return stream << val.ToString();
+}
+
+// val = n 2^e with e even and n long enough for a root of precision + 2
+// bits, the root of n is then exact up to the sticky bit
+BigFloat Sqrt(const BigFloat& val) {
+  assert(val.mantissa_ >= 0);
+
+  BigFloat res(0, 0, val.precision_);
+  if (val.mantissa_ == 0) {
+    return res;
+  }
+
+  int64_t shift =
+      std::max<int64_t>(static_cast<int64_t>(2 * val.precision_ + 4) -
+                            static_cast<int64_t>(val.mantissa_.BitLength()),
+                        0);
+  if ((val.exponent_ - shift) % 2 != 0) {
+    ++shift;
+  }
+
+  BigInt n = val.mantissa_ << static_cast<uint64_t>(shift);
+  BigInt root = ISqrt(n);
+  bool sticky = (root * root != n);
+
+  res.mantissa_ = std::move(root);
+  res.exponent_ = (val.exponent_ - shift) / 2;
+  res.Round(sticky);
+  return res;
+}
+
+BigFloat Exp(const BigFloat& val) {
+  uint64_t precision = val.Precision();
+  if (val.IsZero()) {
+    return BigFloat(1, precision);
+  }
+
+  // Below 2^-(precision + 2) the result rounds to 1, from 2^63 on it is
+  // past the saturation bound and n would be that long
+  int64_t top =
+      val.Exponent() + static_cast<int64_t>(val.Mantissa().BitLength());
+  if (top < -static_cast<int64_t>(precision) - 1) {
+    return BigFloat(1, precision);
+  }
+  auto saturate = [&] {
+    return (val.Mantissa() > 0) ? BigFloat(1, kMaxExpExponent, precision)
+                                : BigFloat(0, 0, precision);
+  };
+  if (top > 63) {
+    return saturate();
+  }
+
+  // val = n ln 2 + r with |r| <= ln 2 / 2, the cancellation costs the bits
+  // of n
+  uint64_t work = WorkPrecision(precision);
+  BigInt n = RoundToInteger(BigFloat(val.Mantissa(), val.Exponent(), 64) /
+                            ConstLn2(64));
+  if (Abs(n) >= kMaxExpExponent) {
+    return saturate();
+  }
+
+  uint64_t reduce_bits = work + n.BitLength();
+  BigFloat r(val.Mantissa(), val.Exponent(), reduce_bits);
+  r -= BigFloat(n, reduce_bits) * ConstLn2(reduce_bits);
+
+  // Bit-burst: chunk j holds the bits 2^j..2^(j+1) after the point, its
+  // series converges the faster the shorter its numerator is
+  BigInt fixed = RoundToInteger(BigFloat(
+      r.Mantissa(), r.Exponent() + static_cast<int64_t>(work), work + 64));
+  bool negative = (fixed < 0);
+  fixed = Abs(fixed);
+
+  BigFloat res(1, work);
+  for (uint64_t lo = 0, hi = 2; lo < work;
+       lo = hi, hi = std::min(2 * hi, work)) {
+    BigInt chunk = (fixed >> (work - hi)) -
+                   ((fixed >> (work - lo)) << (hi - lo));
+    if (chunk != 0) {
+      res *= ExpSeries(negative ? -chunk : chunk, hi, work);
+    }
+  }
+
+  return BigFloat(res.Mantissa(), res.Exponent() + *n.ToInt64(), precision);
+}
+
+BigFloat Log(const BigFloat& val) {
+  assert(val > BigFloat(0));
+
+  uint64_t precision = val.Precision();
+  uint64_t work = WorkPrecision(precision);
+
+  // val = y 2^t with y in [0.5, 1). Around 1 the result cancels against
+  // t ln 2 instead, so y = val there and the precision covers the zeros
+  // of val - 1.
+  int64_t t = val.Exponent() + static_cast<int64_t>(val.Mantissa().BitLength());
+  if (t == 0 || t == 1) {
+    t = 0;
+    BigFloat diff(val.Mantissa(), val.Exponent(), precision + 2);
+    diff -= BigFloat(1, precision + 2);
+    if (diff.IsZero()) {
+      return BigFloat(0, 0, precision);
+    }
+    int64_t diff_top =
+        diff.Exponent() + static_cast<int64_t>(diff.Mantissa().BitLength());
+    work += static_cast<uint64_t>(std::max<int64_t>(-diff_top, 0));
+  }
+  BigFloat y(val.Mantissa(), val.Exponent() - t, work);
+
+  std::vector<uint64_t> steps;
+  for (uint64_t bits = work; bits > kDoubleBits; bits = bits / 2 + 8) {
+    steps.push_back(bits);
+  }
+
+  // z <- z + y exp(-z) - 1
+  BigFloat z = BigFloat::FromDouble(std::log(y.ToDouble()), kDoubleBits);
+  for (auto it = steps.rbegin(); it != steps.rend(); ++it) {
+    z.SetPrecision(*it);
+    BigFloat cur_y = y;
+    cur_y.SetPrecision(*it);
+
+    BigFloat corr = cur_y * Exp(-z);
+    corr -= BigFloat(1, *it);
+    z += corr;
+  }
+
+  if (t != 0) {
+    z += BigFloat(t, work) * ConstLn2(work + 64);
+  }
+  z.SetPrecision(precision);
+  return z;
+}
+
+// 1 / pi = 12 sum (-1)^n (6n)! (A + B n) / ((3n)! (n!)^3 C^(3n + 3/2)),
+// every term adds about 47 bits
+BigFloat ConstPi(uint64_t precision) {
+  uint64_t work = WorkPrecision(precision);
+
+  auto term = [](uint64_t n) {
+    SeriesSplit res{1, 1, 1, BigInt(545140134) * n + 13591409};
+    if (n > 0) {
+      res.p = -(BigInt(6 * n - 5) * (2 * n - 1) * (6 * n - 1));
+      res.q = BigInt(n) * n * n * 10939058860032000;
+    }
+    return res;
+  };
+  SeriesSplit split = BinarySplit(term, 0, work / 47 + 2);
+
+  BigFloat res = Sqrt(BigFloat(10005, work));
+  res *= BigFloat(split.q * 426880, work);
+  res /= BigFloat(split.t, work);
+  res.SetPrecision(precision);
+  return res;
+}
+
+BigFloat ConstE(uint64_t precision) {
+  uint64_t work = WorkPrecision(precision);
+
+  uint64_t terms = 1;
+  for (double bits = 0; bits < work; ++terms) {
+    bits += std::log2(static_cast<double>(terms));
+  }
+
+  auto term = [](uint64_t n) {
+    return SeriesSplit{1, std::max<uint64_t>(n, 1), 1, 1};
+  };
+
+  BigFloat res = SeriesValue(BinarySplit(term, 0, terms + 1), work);
+  res.SetPrecision(precision);
+  return res;
+}
+
+// ln 2 = 2 sum 1 / ((2n + 1) 3^(2n + 1)). Exp needs it at a new precision
+// on every Newton step of Log, so the most precise sum so far is kept per
+// thread and later calls at most that precise just round it.
+BigFloat ConstLn2(uint64_t precision) {
+  static thread_local BigFloat cached(0, 0, 1);
+  uint64_t work = WorkPrecision(precision);
+
+  if (cached.Precision() < work) {
+    auto term = [](uint64_t n) {
+      return SeriesSplit{1, (n == 0) ? 3 : 9, 2 * n + 1, 1};
+    };
+
+    cached = SeriesValue(BinarySplit(term, 0, work / 3 + 2), work);
+    cached *= BigFloat(2, work);
+  }
+
+  BigFloat res = cached;
+  res.SetPrecision(precision);
+  return res;
+}
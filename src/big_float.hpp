@@ -0,0 +1,109 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "big_integer.hpp"
+#include "big_rational.hpp"
+
+// Binary floating point: mantissa * 2^exponent, with the mantissa rounded
+// to at most precision bits. Results take the precision of the left
+// operand. Add, sub, mul, div and Sqrt are correctly rounded to nearest,
+// ties to even; Exp, Log and the constants are accurate to about an ulp.
+class BigFloat {
+ public:
+  static constexpr uint64_t kDefaultPrecision = 128;
+
+  BigFloat() = default;
+  explicit BigFloat(const BigInt& val, uint64_t precision = kDefaultPrecision);
+  BigFloat(BigInt mantissa, int64_t exponent, uint64_t precision);
+
+  static BigFloat FromDouble(double val,
+                             uint64_t precision = kDefaultPrecision);
+
+  // Correctly rounded
+  static BigFloat FromRational(const BigRational& val,
+                               uint64_t precision = kDefaultPrecision);
+
+  // Decimal with an optional exponent, e.g. "-12.5e-3", up to 10^18 either
+  // way. Correctly rounded, also where 10^exp is too long to build exactly.
+  static std::optional<BigFloat> FromString(
+      std::string_view str, uint64_t precision = kDefaultPrecision);
+
+  const BigInt& Mantissa() const { return mantissa_; }
+  int64_t Exponent() const { return exponent_; }
+  uint64_t Precision() const { return precision_; }
+  bool IsZero() const { return mantissa_ == 0; }
+
+  // Rounds when shrinking
+  void SetPrecision(uint64_t precision);
+
+  double ToDouble() const;
+  BigRational ToRational() const;
+
+  // Scientific notation, 0 digits means enough for the precision
+  std::string ToString(std::size_t digits = 0) const;
+
+  BigFloat& operator+=(const BigFloat& other);
+  BigFloat& operator-=(const BigFloat& other);
+  BigFloat& operator*=(const BigFloat& other);
+  BigFloat& operator/=(const BigFloat& other);
+  BigFloat operator-() const;
+
+  std::strong_ordering operator<=>(const BigFloat& other) const;
+  bool operator==(const BigFloat& other) const;
+
+ private:
+  // Rounds the mantissa to precision bits. sticky stands for non-zero bits
+  // below the mantissa, which then needs at least precision + 2 bits.
+  void Round(bool sticky = false);
+  void AddSigned(const BigFloat& other, bool negate);
+
+  BigInt mantissa_;
+  int64_t exponent_ = 0;
+  uint64_t precision_ = kDefaultPrecision;
+
+  friend BigFloat Sqrt(const BigFloat& val);
+};
+
+static BigFloat operator+(BigFloat self, const BigFloat& other) {
+  self += other;
+  return self;
+}
+
+static BigFloat operator-(BigFloat self, const BigFloat& other) {
+  self -= other;
+  return self;
+}
+
+static BigFloat operator*(BigFloat self, const BigFloat& other) {
+  self *= other;
+  return self;
+}
+
+static BigFloat operator/(BigFloat self, const BigFloat& other) {
+  self /= other;
+  return self;
+}
+
+std::ostream& operator<<(std::ostream& stream, const BigFloat& val);
+
+// Correctly rounded, val must not be negative
+BigFloat Sqrt(const BigFloat& val);
+
+// Bit-burst binary splitting after reduction by ln 2. Saturates to
+// 2^(2^62) from about 2^62 ln 2 on and to 0 below the negative.
+BigFloat Exp(const BigFloat& val);
+
+// Newton on Exp with precision doubling, val must be positive
+BigFloat Log(const BigFloat& val);
+
+// Binary splitting: Chudnovsky, sum of 1 / n!, 2 atanh(1 / 3)
+BigFloat ConstPi(uint64_t precision = BigFloat::kDefaultPrecision);
+BigFloat ConstE(uint64_t precision = BigFloat::kDefaultPrecision);
+BigFloat ConstLn2(uint64_t precision = BigFloat::kDefaultPrecision);
@@ -3,26 +3,47 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <climits>
+#include <cmath>
 #include <compare>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <iterator>
+#include <locale>
+#include <numeric>
+#include <span>
 #include <vector>
 
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+#include "big_integer_tuning.hpp"
+
 // ----------------------------------------------------------------------------
 
-static void AddBuffers(std::vector<uint32_t>& lhs,
-                       const std::vector<uint32_t>& rhs);
+// All *To functions write the result into `out`, reusing its capacity.
+// Add & Sub allow `out` to alias any of the inputs.
+
+static void AddBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out);
+
+// Requires |lhs| >= |rhs|
+static void SubBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out);
 
-[[nodiscard("You should check for sign change")]] static BigInt::Sign
-SubBuffers(std::vector<uint32_t>& left_op,
-           const std::vector<uint32_t>& right_op);
+// `out` must not alias inputs
+static void MulBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out);
 
-static std::strong_ordering CompareBuffers(const std::vector<uint32_t>& lhs,
-                                           const std::vector<uint32_t>& rhs);
+// Requires rhs.size() >= 2 and |lhs| >= |rhs|, outputs may alias inputs
+static void DivBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& quot,
+                         Limbs& rem);
+
+static std::strong_ordering CompareBuffers(const Limbs& lhs, const Limbs& rhs);
 
 // ----------------------------------------------------------------------------
 
@@ -32,329 +53,945 @@ constexpr std::size_t BitSize() noexcept {
   return sizeof(T) * CHAR_BIT;
 }
 
-constexpr uint64_t kDecBase = 10;
+constexpr uint32_t kDecBase = 10;
+constexpr int kMinRadix = 2;
+constexpr int kMaxRadix = 36;
+constexpr std::string_view kRadixChars =
+    "0123456789abcdefghijklmnopqrstuvwxyz";
 
-BigInt::Sign SignFromCmp(std::strong_ordering cmp) {
-  if (cmp == std::strong_ordering::less) {
-    return BigInt::Sign::Negative;
+// Hash constants (64-bit primes from wyhash)
+constexpr std::array<uint64_t, 4> kHashSecrets = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL,
+    0x589965cc75374cc3ULL};
+constexpr std::size_t kHashLanes = kHashSecrets.size();
+
+void GCDigits(Limbs& digits) {
+  while (!digits.empty() && digits[digits.size() - 1] == 0) {
+    digits.pop_back();
+  }
+}
+
+// Thread-local scratch up to this many limbs is kept for the next call,
+// larger buffers are freed so one huge operation doesn't pin its memory for
+// the lifetime of the thread
+constexpr std::size_t kMaxKeptScratchLimbs = std::size_t{1} << 16;
+
+void ReleaseScratch(Limbs& scratch) {
+  if (scratch.capacity() > kMaxKeptScratchLimbs) {
+    scratch = Limbs();
   }
+}
 
-  if (cmp == std::strong_ordering::greater) {
-    return BigInt::Sign::Positive;
+std::size_t BitLength(const Limbs& digits) {
+  if (digits.empty()) {
+    return 0;
   }
 
-  return BigInt::Sign::Zero;
+  return (digits.size() - 1) * BitSize<uint32_t>() +
+         std::bit_width(digits.back());
 }
 
-void GCDigits(std::vector<uint32_t>& digits) {
-  while (!digits.empty() && digits[digits.size() - 1] == 0) {
-    digits.pop_back();
+// Returns 64 bits starting from bit `low`, with the lowest bit ORed with all
+// the bits below `low` (sticky bit for correct rounding)
+uint64_t ExtractTopBits(const Limbs& digits, std::size_t low) {
+  std::size_t index = low / BitSize<uint32_t>();
+  std::size_t offset = low % BitSize<uint32_t>();
+
+  UInt128 window = 0;
+  for (std::size_t i = std::min(index + 3, digits.size()); i > index; --i) {
+    window = (window << BitSize<uint32_t>()) | digits[i - 1];
+  }
+
+  bool sticky = (digits[index] & ((1U << offset) - 1)) != 0;
+  for (std::size_t i = 0; i < index && !sticky; ++i) {
+    sticky = digits[i] != 0;
   }
+
+  return static_cast<uint64_t>(window >> offset) | (sticky ? 1 : 0);
 }
-};  // namespace
 
-// ----------------------------------------------------------------------------
+// Folded 64x64->128 multiplication
+uint64_t HashMix(uint64_t lhs, uint64_t rhs) {
+  UInt128 prod = static_cast<UInt128>(lhs) * rhs;
+  return static_cast<uint64_t>(prod) ^
+         static_cast<uint64_t>(prod >> BitSize<uint64_t>());
+}
 
-BigInt::BigInt(int64_t val) {
-  if (val == 0) {
-    return;
+uint64_t LoadWord(const Limbs& digits, std::size_t index) {
+  return digits[index] |
+         (static_cast<uint64_t>(digits[index + 1]) << BitSize<uint32_t>());
+}
+
+// Largest power of radix that fits in a limb and its exponent
+struct RadixChunk {
+  uint32_t power;
+  std::size_t len;
+};
+
+RadixChunk ChunkFor(uint32_t radix) {
+  RadixChunk chunk{radix, 1};
+
+  while (static_cast<uint64_t>(chunk.power) * radix <= UINT32_MAX) {
+    chunk.power *= radix;
+    ++chunk.len;
   }
 
-  uint64_t val_abs;
+  return chunk;
+}
 
-  if (val > 0) {
-    val_abs = static_cast<uint64_t>(val);
-    sign_ = Sign::Positive;
-  } else {
-    val_abs = (val != INT64_MIN) ? -val : static_cast<uint64_t>(INT64_MAX) + 1;
-    sign_ = Sign::Negative;
+// Returns kMaxRadix for non-digit chars
+uint32_t DigitValue(char chr) {
+  if (chr >= '0' && chr <= '9') {
+    return chr - '0';
+  }
+  if (chr >= 'a' && chr <= 'z') {
+    return chr - 'a' + kDecBase;
+  }
+  if (chr >= 'A' && chr <= 'Z') {
+    return chr - 'A' + kDecBase;
+  }
+
+  return kMaxRadix;
+}
+
+// digits = digits * mul + add
+void MulAddSmall(Limbs& digits, uint32_t mul, uint32_t add) {
+  uint64_t carry = add;
+
+  for (auto& digit : digits) {
+    carry += static_cast<uint64_t>(digit) * mul;
+    digit = carry & UINT32_MAX;
+    carry >>= BitSize<uint32_t>();
   }
 
-  digits_.emplace_back(val_abs & UINT32_MAX);
-  if (val_abs > UINT32_MAX) {
-    val_abs >>= BitSize<uint32_t>();
-    digits_.emplace_back(val_abs);
+  if (carry != 0) {
+    digits.emplace_back(carry);
   }
 }
 
-BigInt::BigInt(std::string_view decimal_input) {
-  const auto* it = decimal_input.begin();
-  if (*it == '-') {
-    sign_ = Sign::Negative;
-    ++it;
+// digits /= divisor, returns remainder
+uint32_t DivSmall(Limbs& digits, uint32_t divisor) {
+  uint64_t rem = 0;
+
+  for (auto it = digits.rbegin(); it != digits.rend(); ++it) {
+    uint64_t cur = (rem << BitSize<uint32_t>()) | *it;
+    *it = static_cast<uint32_t>(cur / divisor);
+    rem = cur % divisor;
   }
 
-  BigInt tmp(0);
+  GCDigits(digits);
+  return static_cast<uint32_t>(rem);
+}
+
+// ChunkFor(radix).power^(2^level). Conversions keep asking for the same
+// powers, so they are cached per thread; deque keeps references stable.
+const Limbs& RadixPower(uint32_t radix, std::size_t level) {
+  static thread_local std::array<std::deque<Limbs>, kMaxRadix + 1> cache;
+  auto& powers = cache[radix];
 
-  for (const auto* end = decimal_input.end(); it < end; ++it) {
-    tmp *= kDecBase;
-    tmp += (*it - '0');
+  if (powers.empty()) {
+    powers.emplace_back(1, ChunkFor(radix).power);
   }
 
-  digits_ = std::move(tmp.digits_);
+  while (powers.size() <= level) {
+    Limbs next;
+    MulBuffersTo(powers.back(), powers.back(), next);
+    powers.emplace_back(std::move(next));
+  }
 
-  // sign correcting
-  if (sign_ != Sign::Negative && !digits_.empty()) {
-    sign_ = Sign::Positive;
-  } else if (sign_ == Sign::Negative && digits_.empty()) {
-    sign_ = Sign::Zero;
+  return powers[level];
+}
+
+// Appends chars in reversed order, at least width of them (zero padded).
+// Above the radix_conversion threshold splits by the radix power of about
+// half the size: the remainder gives the low chars, the quotient the rest.
+void ChunkRadixToChars(const Limbs& digits, uint32_t radix, std::size_t width,
+                       std::string& buf) {
+  auto chunk = ChunkFor(radix);
+  std::size_t start = buf.size();
+  std::size_t level = 1;
+
+  if (digits.size() >= GetThresholds().radix_conversion &&
+      2 * RadixPower(radix, level).size() - 1 <= digits.size()) {
+    while (2 * RadixPower(radix, level + 1).size() - 1 <= digits.size()) {
+      ++level;
+    }
+
+    Limbs quot;
+    Limbs rem;
+    DivBuffersTo(digits, RadixPower(radix, level), quot, rem);
+    ChunkRadixToChars(rem, radix, chunk.len << level, buf);
+    ChunkRadixToChars(quot, radix, 0, buf);
+  } else {
+    Limbs rest = digits;
+
+    while (!rest.empty()) {
+      uint32_t value = DivSmall(rest, chunk.power);
+      for (std::size_t i = 0; i < chunk.len; ++i, value /= radix) {
+        buf += kRadixChars[value % radix];
+      }
+    }
+  }
+
+  if (buf.size() < start + width) {
+    buf.resize(start + width, '0');
   }
 }
 
-BigInt& BigInt::operator+=(const BigInt& other) {
-  // Math optimizations
-  if (other.sign_ == Sign::Zero) {
-    return *this;
+// Appends chars in reversed order, radix = 2^bits
+void PowerRadixToChars(const Limbs& digits, int bits, std::string& buf) {
+  std::size_t bit_len = BitLength(digits);
+  uint32_t mask = (1U << bits) - 1;
+
+  for (std::size_t pos = 0; pos < bit_len; pos += bits) {
+    std::size_t index = pos / BitSize<uint32_t>();
+    std::size_t offset = pos % BitSize<uint32_t>();
+
+    uint64_t window = digits[index] >> offset;
+    if (offset + bits > BitSize<uint32_t>() && index + 1 < digits.size()) {
+      window |= static_cast<uint64_t>(digits[index + 1])
+                << (BitSize<uint32_t>() - offset);
+    }
+
+    buf += kRadixChars[window & mask];
   }
+}
 
-  if (sign_ == Sign::Zero) {
-    *this = other;
-    return *this;
+bool PowerRadixFromChars(std::string_view input, int bits, Limbs& digits) {
+  digits.assign((input.size() * bits + BitSize<uint32_t>() - 1) /
+                    BitSize<uint32_t>(),
+                0);
+  std::size_t pos = 0;
+
+  for (auto it = input.rbegin(); it != input.rend(); ++it, pos += bits) {
+    uint32_t value = DigitValue(*it);
+    if ((value >> bits) != 0) {
+      return false;
+    }
+
+    std::size_t index = pos / BitSize<uint32_t>();
+    std::size_t offset = pos % BitSize<uint32_t>();
+
+    digits[index] |= value << offset;
+    if (offset + bits > BitSize<uint32_t>()) {
+      digits[index + 1] |= value >> (BitSize<uint32_t>() - offset);
+    }
   }
 
-  // Check signs
-  if (sign_ == other.sign_) {
-    AddBuffers(digits_, other.digits_);
-  } else {
-    auto res_sign = SubBuffers(digits_, other.digits_);
-    sign_ = sign_ * res_sign;
+  GCDigits(digits);
+  return true;
+}
+
+// Horner's scheme over limb-sized chunks of chars
+bool HornerFromChars(std::string_view input, uint32_t radix, Limbs& digits) {
+  auto chunk = ChunkFor(radix);
+  std::size_t group = input.size() % chunk.len;
+  group = (group == 0) ? chunk.len : group;
+
+  digits.clear();
+  digits.reserve(input.size() * std::bit_width(radix) / BitSize<uint32_t>() +
+                 1);
+
+  for (std::size_t pos = 0; pos < input.size();
+       pos += group, group = chunk.len) {
+    uint32_t value = 0;
+    uint32_t mul = 1;
+
+    for (char chr : input.substr(pos, group)) {
+      uint32_t digit = DigitValue(chr);
+      if (digit >= radix) {
+        return false;
+      }
+
+      value = value * radix + digit;
+      mul *= radix;
+    }
+
+    MulAddSmall(digits, mul, value);
   }
 
-  return *this;
+  return true;
 }
 
-BigInt& BigInt::operator-=(const BigInt& other) {
-  // Math optimizations
-  if (other.sign_ == Sign::Zero) {
-    return *this;
+// Above the radix_conversion threshold splits off the low chars of about
+// half the input: digits = high * radix^low_len + low
+bool ChunkRadixFromChars(std::string_view input, uint32_t radix,
+                         Limbs& digits) {
+  auto chunk = ChunkFor(radix);
+
+  if (input.size() < 2 * chunk.len ||
+      input.size() / chunk.len < GetThresholds().radix_conversion) {
+    return HornerFromChars(input, radix, digits);
   }
 
-  if (sign_ == Sign::Zero) {
-    *this = -other;
-    return *this;
+  std::size_t level = 0;
+  while ((chunk.len << (level + 1)) * 2 <= input.size()) {
+    ++level;
   }
 
-  // Check signs
-  if (sign_ == other.sign_) {
-    auto res_sign = SubBuffers(digits_, other.digits_);
-    sign_ = sign_ * res_sign;
+  std::size_t low_len = chunk.len << level;
+  Limbs high;
+  Limbs low;
+
+  if (!ChunkRadixFromChars(input.substr(0, input.size() - low_len), radix,
+                           high) ||
+      !ChunkRadixFromChars(input.substr(input.size() - low_len), radix, low)) {
+    return false;
+  }
+
+  if (high.empty()) {
+    digits = std::move(low);
   } else {
-    AddBuffers(digits_, other.digits_);
+    MulBuffersTo(high, RadixPower(radix, level), digits);
+    AddBuffersTo(digits, low, digits);
   }
 
-  return *this;
+  return true;
 }
 
-BigInt& BigInt::operator*=(const BigInt& other) {
-  if (sign_ == Sign::Zero) {
-    return *this;
+// digits >>= shift, shift < 32
+void ShiftRightBits(Limbs& digits, std::size_t shift) {
+  if (shift == 0) {
+    return;
   }
-  if (other.sign_ == Sign::Zero) {
-    *this = BigInt(0);
-    return *this;
+
+  for (std::size_t i = 0; i < digits.size(); ++i) {
+    uint64_t next = (i + 1 < digits.size()) ? digits[i + 1] : 0;
+    digits[i] = ((next << BitSize<uint32_t>()) | digits[i]) >> shift;
   }
 
-  sign_ = sign_ * other.sign_;
-  std::vector<uint32_t> new_digits(digits_.size() + other.digits_.size(), 0);
+  GCDigits(digits);
+}
+
+// Incremental digit parser for streams: chars are folded into limb-sized
+// chunks as they come, so memory is bounded by the size of the result.
+class DigitAccumulator {
+ public:
+  explicit DigitAccumulator(uint32_t radix)
+      : radix_(radix),
+        chunk_(ChunkFor(radix)),
+        bits_(std::has_single_bit(radix) ? std::countr_zero(radix) : 0) {}
+
+  // Returns false if chr is not a digit in this radix
+  bool Push(char chr) {
+    uint32_t digit = DigitValue(chr);
+    if (digit >= radix_) {
+      return false;
+    }
+
+    if (bits_ > 0) {
+      PushBits(digit);
+    } else {
+      PushChunk(digit);
+    }
 
-  for (uint64_t i = 0; i < digits_.size(); ++i) {
-    for (uint64_t j = 0; j < other.digits_.size(); ++j) {
-      uint64_t carry = static_cast<uint64_t>(digits_[i]) * other.digits_[j];
+    return true;
+  }
 
-      for (size_t k = i + j; carry > 0; ++k) {
-        assert(k < new_digits.size());
+  void Finish(Limbs& out) {
+    if (bits_ == 0 && len_ > 0) {
+      MulAddSmall(digits_, static_cast<uint32_t>(mul_),
+                  static_cast<uint32_t>(value_));
+    }
 
-        carry += new_digits[k];
-        new_digits[k] = carry & UINT32_MAX;
-        carry >>= BitSize<uint32_t>();
+    if (bits_ > 0) {
+      // Limbs were collected most significant first, top-aligned
+      std::size_t pad = 0;
+      if (len_ > 0) {
+        pad = BitSize<uint32_t>() - len_;
+        digits_.emplace_back(static_cast<uint32_t>(value_ << pad));
       }
+
+      std::reverse(digits_.begin(), digits_.end());
+      ShiftRightBits(digits_, pad);
     }
+
+    GCDigits(digits_);
+    out = std::move(digits_);
   }
 
-  digits_ = std::move(new_digits);
-  GCDigits(digits_);
+ private:
+  // Horner's scheme, one multiplication per limb-sized chunk
+  void PushChunk(uint32_t digit) {
+    value_ = value_ * radix_ + digit;
+    mul_ *= radix_;
+
+    if (++len_ == chunk_.len) {
+      MulAddSmall(digits_, static_cast<uint32_t>(mul_),
+                  static_cast<uint32_t>(value_));
+      value_ = 0;
+      mul_ = 1;
+      len_ = 0;
+    }
+  }
 
-  return *this;
+  // Linear bit packing, total length isn't known until the end
+  void PushBits(uint32_t digit) {
+    value_ = (value_ << bits_) | digit;
+    len_ += bits_;
+
+    if (len_ >= BitSize<uint32_t>()) {
+      len_ -= BitSize<uint32_t>();
+      digits_.emplace_back(static_cast<uint32_t>(value_ >> len_));
+      value_ &= (1ULL << len_) - 1;
+    }
+  }
+
+  uint32_t radix_;
+  RadixChunk chunk_;
+  int bits_;
+
+  // Pending chars: value, radix^count (or bit count for 2^k radixes)
+  uint64_t value_ = 0;
+  uint64_t mul_ = 1;
+  std::size_t len_ = 0;
+
+  Limbs digits_;
+};
+
+// |digits| += abs
+void AddMagnitude(Limbs& digits, uint64_t abs) {
+  uint64_t carry = abs;
+
+  for (auto it = digits.begin(); carry > 0 && it != digits.end(); ++it) {
+    uint64_t sum = (carry & UINT32_MAX) + *it;
+    *it = sum & UINT32_MAX;
+    carry = (carry >> BitSize<uint32_t>()) + (sum >> BitSize<uint32_t>());
+  }
+
+  for (; carry > 0; carry >>= BitSize<uint32_t>()) {
+    digits.emplace_back(carry & UINT32_MAX);
+  }
 }
 
-BigInt BigInt::GetDivDigit(const BigInt& other) const {
-  uint64_t head_lhs = GetHead();
-  uint64_t head_rhs = other.GetHead((int64_t)digits_.size() - 2);
+// |digits| -= abs, requires |digits| > abs
+void SubMagnitude(Limbs& digits, uint64_t abs) {
+  uint64_t borrow = 0;
+
+  for (auto it = digits.begin(); abs > 0 || borrow > 0; ++it) {
+    assert(it != digits.end());
 
-  if (head_rhs != UINT64_MAX) {
-    return BigInt(std::min(head_lhs / (head_rhs + 1), (uint64_t)INT64_MAX));
-  } /* else */  // due to clang-tidy
+    uint64_t sub = (abs & UINT32_MAX) + borrow;
+    abs >>= BitSize<uint32_t>();
 
-  assert(head_rhs == head_lhs);
-  return BigInt(1);
+    borrow = (*it < sub) ? 1 : 0;
+    *it = (borrow << BitSize<uint32_t>()) + *it - sub;
+  }
+
+  GCDigits(digits);
 }
+};  // namespace
 
-// return div result
-BigInt BigInt::DivOneIter(const BigInt& other) {
-  BigInt cur_sub = other;
-  cur_sub.sign_ = Sign::Positive;
+// ----------------------------------------------------------------------------
 
-  uint64_t zero_cnt = std::max(digits_.size() - other.digits_.size(), 1UL) - 1;
+BigInt::BigInt(int64_t val) : BigInt(NativeSign(val), NativeAbs(val)) {}
 
-  cur_sub.LeftShift(zero_cnt);
-  BigInt div_digit = GetDivDigit(cur_sub);
+BigInt::BigInt(uint64_t val) : BigInt(NativeSign(val), val) {}
 
-  cur_sub *= div_digit;
-  div_digit.LeftShift(zero_cnt);
+BigInt::BigInt(Int128 val)
+    : BigInt(val < 0 ? Sign::Negative : Sign::Positive,
+             val < 0 ? 0 - static_cast<UInt128>(val)
+                     : static_cast<UInt128>(val)) {}
 
-  *this -= cur_sub;
-  return div_digit;
+BigInt::BigInt(UInt128 val) : BigInt(Sign::Positive, val) {}
+
+BigInt::BigInt(Sign sign, UInt128 abs) : sign_(sign) { AssignMagnitude(abs); }
+
+void BigInt::AssignMagnitude(UInt128 abs) {
+  digits_.clear();
+
+  for (; abs > 0; abs >>= BitSize<uint32_t>()) {
+    digits_.emplace_back(static_cast<uint32_t>(abs & UINT32_MAX));
+  }
+
+  if (digits_.empty()) {
+    sign_ = Sign::Zero;
+  }
 }
 
-BigInt& BigInt::operator/=(const BigInt& other) {
-  if (other == BigInt(1) || sign_ == Sign::Zero) {
-    return *this;
+uint64_t BigInt::LowMagnitude() const {
+  uint64_t ans = digits_.empty() ? 0 : digits_[0];
+
+  if (digits_.size() > 1) {
+    ans |= static_cast<uint64_t>(digits_[1]) << BitSize<uint32_t>();
   }
-  if (CompareBuffers(digits_, other.digits_) == std::strong_ordering::less) {
-    *this = BigInt(0);
-    return *this;
+
+  return ans;
+}
+
+BigInt::BigInt(std::string_view decimal_input) {
+  auto parsed = FromString(decimal_input);
+  assert(parsed.has_value());
+
+  if (parsed) {
+    *this = std::move(*parsed);
   }
+}
 
-  auto res_sign = sign_ * other.sign_;
-  sign_ = Sign::Positive;
-  BigInt div_result = BigInt(0);
-  std::strong_ordering cmp = std::strong_ordering::equal;
+std::string BigInt::ToString(int radix) const {
+  assert(radix >= kMinRadix && radix <= kMaxRadix);
+  BIGINT_STATS_OP(ToString, digits_.size());
 
-  while ((cmp = CompareBuffers(digits_, other.digits_)) ==
-         std::strong_ordering::greater) {
-    div_result += DivOneIter(other);
+  if (sign_ == Sign::Zero) {
+    return "0";
   }
 
-  if (cmp == std::strong_ordering::equal) {
-    div_result += 1;
+  auto uradix = static_cast<uint32_t>(radix);
+  std::string buf;  // reversed
+  buf.reserve(::BitLength(digits_) / (std::bit_width(uradix) - 1) + 2);
+
+  if (std::has_single_bit(uradix)) {
+    PowerRadixToChars(digits_, std::countr_zero(uradix), buf);
+  } else {
+    ChunkRadixToChars(digits_, uradix, 0, buf);
+
+    while (buf.back() == '0') {
+      buf.pop_back();
+    }
   }
 
-  *this = std::move(div_result);
-  sign_ = res_sign;
-  return *this;
+  if (sign_ == Sign::Negative) {
+    buf += '-';
+  }
+
+  std::reverse(buf.begin(), buf.end());
+  return buf;
 }
 
-uint64_t BigInt::GetHead(int64_t start_index) const {
-  uint64_t ans = 0;
+std::optional<BigInt> BigInt::FromString(std::string_view input, int radix) {
+  assert(radix >= kMinRadix && radix <= kMaxRadix);
 
-  int64_t num_of_digits = static_cast<int64_t>(digits_.size());
+  Sign sign = Sign::Positive;
+  if (!input.empty() && (input.front() == '-' || input.front() == '+')) {
+    sign = (input.front() == '-') ? Sign::Negative : Sign::Positive;
+    input.remove_prefix(1);
+  }
 
-  if (!digits_.empty() && start_index <= num_of_digits - 1) {
-    ans += digits_[digits_.size() - 1];
+  if (input.empty()) {
+    return std::nullopt;
   }
 
-  if (digits_.size() > 1 && start_index <= num_of_digits - 2) {
-    ans <<= BitSize<uint32_t>();
-    ans |= digits_[digits_.size() - 2];
+  BigInt res;
+  auto uradix = static_cast<uint32_t>(radix);
+  bool valid =
+      std::has_single_bit(uradix)
+          ? PowerRadixFromChars(input, std::countr_zero(uradix), res.digits_)
+          : ChunkRadixFromChars(input, uradix, res.digits_);
+
+  if (!valid) {
+    return std::nullopt;
   }
 
-  return ans;
+  res.sign_ = res.digits_.empty() ? Sign::Zero : sign;
+  BIGINT_STATS_OP(Parse, res.digits_.size());
+  return res;
+}
+
+BigInt& BigInt::operator+=(const BigInt& other) {
+  Add(*this, *this, other);
+  return *this;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other) {
+  Sub(*this, *this, other);
+  return *this;
+}
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+  Mul(*this, *this, other);
+  return *this;
+}
+
+BigInt& BigInt::operator/=(const BigInt& other) {
+  BigInt rem;
+  DivMod(*this, rem, *this, other);
+  return *this;
 }
 
 BigInt& BigInt::operator%=(const BigInt& other) {
-  *this = *this - (*this / other) * other;
+  BigInt quot;
+  DivMod(quot, *this, *this, other);
   return *this;
 }
 
-BigInt& BigInt::operator+=(int32_t other) {
-  if (other == 0) {
+// dst = lhs + rhs_sign * |rhs|
+void BigInt::AddSigned(BigInt& dst, const BigInt& lhs, const BigInt& rhs,
+                       Sign rhs_sign) {
+  if (rhs_sign == Sign::Zero) {
+    dst = lhs;
+    return;
+  }
+
+  if (lhs.sign_ == Sign::Zero) {
+    dst.digits_ = rhs.digits_;
+    dst.sign_ = rhs_sign;
+    return;
+  }
+
+  if (lhs.sign_ == rhs_sign) {
+    AddBuffersTo(lhs.digits_, rhs.digits_, dst.digits_);
+    dst.sign_ = rhs_sign;
+    return;
+  }
+
+  auto cmp = CompareBuffers(lhs.digits_, rhs.digits_);
+  Sign res_sign = (cmp == std::strong_ordering::less) ? rhs_sign : lhs.sign_;
+
+  if (cmp == std::strong_ordering::less) {
+    SubBuffersTo(rhs.digits_, lhs.digits_, dst.digits_);
+  } else {
+    SubBuffersTo(lhs.digits_, rhs.digits_, dst.digits_);
+  }
+
+  dst.sign_ = dst.digits_.empty() ? Sign::Zero : res_sign;
+}
+
+void Add(BigInt& dst, const BigInt& lhs, const BigInt& rhs) {
+  BIGINT_STATS_OP(Add, std::max(lhs.digits_.size(), rhs.digits_.size()));
+  BigInt::AddSigned(dst, lhs, rhs, rhs.sign_);
+}
+
+void Sub(BigInt& dst, const BigInt& lhs, const BigInt& rhs) {
+  BIGINT_STATS_OP(Sub, std::max(lhs.digits_.size(), rhs.digits_.size()));
+  BigInt::AddSigned(dst, lhs, rhs, BigInt::OppositeSign(rhs.sign_));
+}
+
+void Mul(BigInt& dst, const BigInt& lhs, const BigInt& rhs) {
+  BigInt::Sign res_sign = lhs.sign_ * rhs.sign_;
+
+  if (&lhs == &rhs) {
+    BIGINT_STATS_OP(Sqr, lhs.digits_.size());
+  } else {
+    BIGINT_STATS_OP(Mul, std::max(lhs.digits_.size(), rhs.digits_.size()));
+  }
+
+  if (res_sign == BigInt::Sign::Zero) {
+    dst.digits_.clear();
+  } else if (&dst != &lhs && &dst != &rhs) {
+    MulBuffersTo(lhs.digits_, rhs.digits_, dst.digits_);
+  } else {
+    // Result can't overwrite operands, old dst buffer becomes next scratch
+    static thread_local Limbs scratch;
+    MulBuffersTo(lhs.digits_, rhs.digits_, scratch);
+    std::swap(scratch, dst.digits_);
+    ReleaseScratch(scratch);
+  }
+
+  dst.sign_ = res_sign;
+}
+
+// Divisor and quotient both this many limbs (and at least the newton_div
+// threshold) switch DivMod to a Newton reciprocal
+constexpr std::size_t kMinNewtonDivSize = 4;
+
+// Reciprocals this short come straight from Knuth division
+constexpr uint64_t kMinNewtonRecipBits = 64;
+
+// About 2^(BitLength(d) + n) / d, off by a few units: each Newton step
+// x + x (1 - d x) doubles the precision of the one before, and only reads
+// as many top bits of d as it needs
+static BigInt NewtonReciprocal(const BigInt& d, uint64_t n) {
+  uint64_t len = d.BitLength();
+  uint64_t top_bits = std::min(len, n + 4);
+  BigInt top = d >> (len - top_bits);
+
+  if (n <= kMinNewtonRecipBits) {
+    return (BigInt(1) << (top_bits + n)) / top;
+  }
+
+  uint64_t half_bits = n / 2 + 2;
+  BigInt half = NewtonReciprocal(d, half_bits);
+
+  // 2^(top_bits + half_bits) times the relative error of half
+  BigInt err = BigInt(1) << (top_bits + half_bits);
+  err -= top * half;
+
+  BigInt res = half << (n - half_bits);
+  res += (half * err) >> (top_bits + 2 * half_bits - n);
+  return res;
+}
+
+// Floor division of a >= 0 by d > 0 at the speed of multiplication
+static void NewtonDivMod(BigInt& quot, BigInt& rem, const BigInt& a,
+                         const BigInt& d) {
+  uint64_t a_len = a.BitLength();
+  uint64_t d_len = d.BitLength();
+
+  // The low bits of a barely move the quotient, drop them
+  uint64_t n = a_len - d_len + 3;
+  uint64_t drop = d_len - 4;
+  quot = ((a >> drop) * NewtonReciprocal(d, n)) >> (d_len + n - drop);
+
+  rem = a - quot * d;
+  while (rem < 0) {
+    --quot;
+    rem += d;
+  }
+  while (rem >= d) {
+    ++quot;
+    rem -= d;
+  }
+}
+
+void DivMod(BigInt& quot, BigInt& rem, const BigInt& lhs, const BigInt& rhs) {
+  assert(&quot != &rem);
+  assert(rhs.sign_ != BigInt::Sign::Zero);
+  BIGINT_STATS_OP(DivMod, lhs.digits_.size());
+
+  BigInt::Sign quot_sign = lhs.sign_ * rhs.sign_;
+  BigInt::Sign rem_sign = lhs.sign_;
+  std::size_t newton = std::max(GetThresholds().newton_div, kMinNewtonDivSize);
+
+  if (CompareBuffers(lhs.digits_, rhs.digits_) == std::strong_ordering::less) {
+    rem = lhs;  // before clearing quot, it may alias lhs
+    quot.digits_.clear();
+  } else if (rhs.digits_.size() == 1) {
+    uint32_t divisor = rhs.digits_[0];
+    quot.digits_ = lhs.digits_;
+    rem.AssignMagnitude(quot.DivModMagnitude(divisor));
+  } else if (rhs.digits_.size() >= newton &&
+             lhs.digits_.size() - rhs.digits_.size() >= newton) {
+    // Magnitudes are copied first, quot and rem may alias the operands
+    NewtonDivMod(quot, rem, BigInt(BigInt::Sign::Positive, lhs.digits_),
+                 BigInt(BigInt::Sign::Positive, rhs.digits_));
+  } else {
+    DivBuffersTo(lhs.digits_, rhs.digits_, quot.digits_, rem.digits_);
+  }
+
+  quot.sign_ = quot.digits_.empty() ? BigInt::Sign::Zero : quot_sign;
+  rem.sign_ = rem.digits_.empty() ? BigInt::Sign::Zero : rem_sign;
+}
+
+// Euclid, switching to machine words once the smaller operand fits
+BigInt Gcd(const BigInt& lhs, const BigInt& rhs) {
+  BigInt big = (lhs < 0) ? -lhs : lhs;
+  BigInt small = (rhs < 0) ? -rhs : rhs;
+  BigInt rem;
+  BigInt quot;
+
+  while (small != 0) {
+    if (auto word = small.ToUint64()) {
+      big %= *word;
+      return std::gcd(*big.ToUint64(), *word);
+    }
+
+    DivMod(quot, rem, big, small);
+    std::swap(big, small);
+    std::swap(small, rem);
+  }
+
+  return big;
+}
+
+BigInt& BigInt::AddNative(Sign sign, uint64_t abs) {
+  BIGINT_STATS_OP(NativeAdd, digits_.size());
+
+  if (sign == Sign::Zero) {
     return *this;
   }
 
   if (sign_ == Sign::Zero) {
-    *this = BigInt(other);
+    sign_ = sign;
+    AssignMagnitude(abs);
+    return *this;
+  }
+
+  if (sign_ == sign) {
+    AddMagnitude(digits_, abs);
     return *this;
   }
 
-  if (!IsSameSignAs(other)) {
-    *this -= -other;
+  // Different signs: |this| - abs
+  if (digits_.size() > 2 || LowMagnitude() > abs) {
+    SubMagnitude(digits_, abs);
     return *this;
   }
 
-  uint64_t carry = (other > 0) ? other : -other;
+  sign_ = sign;
+  AssignMagnitude(abs - LowMagnitude());
+  return *this;
+}
+
+BigInt& BigInt::MulNative(Sign sign, uint64_t abs) {
+  BIGINT_STATS_OP(NativeMul, digits_.size());
+
+  if (sign_ == Sign::Zero) {
+    return *this;
+  }
+
+  if (sign == Sign::Zero) {
+    sign_ = Sign::Zero;
+    digits_.clear();
+    return *this;
+  }
+
+  sign_ = sign_ * sign;
+  UInt128 carry = 0;
 
   for (auto& digit : digits_) {
-    carry += digit;
-    digit = carry & UINT32_MAX;
+    carry += static_cast<UInt128>(digit) * abs;
+    digit = static_cast<uint32_t>(carry & UINT32_MAX);
     carry >>= BitSize<uint32_t>();
   }
 
-  if (carry > 0) {
-    digits_.emplace_back(carry);
+  for (; carry > 0; carry >>= BitSize<uint32_t>()) {
+    digits_.emplace_back(static_cast<uint32_t>(carry & UINT32_MAX));
   }
 
   return *this;
 }
 
-template <typename InputIt, typename OutputIt>
-static void PropagateSubCarry(uint64_t carry, InputIt lhs_it, OutputIt out_it) {
-  for (; carry > 0; ++lhs_it, ++out_it) {
-    uint64_t digit = *lhs_it;
-    if (digit >= carry) {
-      *out_it = digit - carry;
-      carry = 0;
-    } else {
-      *out_it = UINT32_MAX - carry + digit + 1;
-      carry = 1;
+// |this| /= divisor, returns remainder
+uint64_t BigInt::DivModMagnitude(uint64_t divisor) {
+  assert(divisor != 0);
+
+  UInt128 rem = 0;
+
+  if (divisor <= UINT32_MAX) {
+    // Everything fits in 64 bits, avoid slow 128-bit division
+    uint64_t small_rem = 0;
+    for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
+      uint64_t cur = (small_rem << BitSize<uint32_t>()) | *it;
+      *it = cur / divisor;
+      small_rem = cur % divisor;
+    }
+    rem = small_rem;
+  } else {
+    for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
+      UInt128 cur = (rem << BitSize<uint32_t>()) | *it;
+      *it = static_cast<uint32_t>(cur / divisor);
+      rem = cur % divisor;
     }
   }
+
+  GCDigits(digits_);
+  if (digits_.empty()) {
+    sign_ = Sign::Zero;
+  }
+
+  return static_cast<uint64_t>(rem);
 }
 
-BigInt& BigInt::operator-=(int32_t other) {
-  if (other == 0) {
-    return *this;
+uint32_t BigInt::ModLimb(uint32_t divisor) const {
+  assert(divisor != 0);
+
+  uint64_t rem = 0;
+  for (auto it = digits_.rbegin(); it != digits_.rend(); ++it) {
+    rem = ((rem << BitSize<uint32_t>()) | *it) % divisor;
   }
+
+  return static_cast<uint32_t>(rem);
+}
+
+BigInt& BigInt::DivNative(Sign sign, uint64_t abs) {
+  BIGINT_STATS_OP(NativeDivMod, digits_.size());
+
   if (sign_ == Sign::Zero) {
-    *this = BigInt(-other);
-    return *this;
-  }
-  if (!IsSameSignAs(other)) {
-    *this += -other;
     return *this;
   }
 
-  uint64_t carry = (other > 0) ? other : -other;
+  Sign res_sign = sign_ * sign;
+  DivModMagnitude(abs);
 
-  if (digits_.size() == 1) {
-    sign_ = sign_ * SignFromCmp(digits_[0] <=> carry);
-    digits_[0] = std::abs(static_cast<int64_t>(digits_[0]) -
-                          static_cast<int64_t>(carry));
-  } else {
-    PropagateSubCarry(carry, digits_.begin(), digits_.begin());
+  if (sign_ != Sign::Zero) {
+    sign_ = res_sign;
   }
 
-  GCDigits(digits_);
   return *this;
 }
 
-BigInt& BigInt::operator*=(int32_t other) {
+// Remainder takes the sign of the dividend, as for native ints
+BigInt& BigInt::ModNative(uint64_t abs) {
+  BIGINT_STATS_OP(NativeDivMod, digits_.size());
+
   if (sign_ == Sign::Zero) {
     return *this;
   }
 
-  if (other == 0) {
-    *this = BigInt(0);
-    return *this;
+  Sign res_sign = sign_;
+  uint64_t rem = DivModMagnitude(abs);
+
+  sign_ = res_sign;
+  AssignMagnitude(rem);
+  return *this;
+}
+
+std::strong_ordering BigInt::CmpNative(Sign sign, uint64_t abs) const {
+  if (sign_ != sign) {
+    return sign_ <=> sign;
   }
 
-  if (other < 0) {
-    sign_ = OppositeSign(sign_);
-    other = -other;
+  if (sign_ == Sign::Zero) {
+    return std::strong_ordering::equal;
   }
 
-  uint64_t carry = 0;
+  auto abs_cmp = (digits_.size() > 2) ? std::strong_ordering::greater
+                                      : LowMagnitude() <=> abs;
 
-  for (auto& digit : digits_) {
-    carry += static_cast<uint64_t>(digit) * other;
-    digit = carry & UINT32_MAX;
-    carry >>= BitSize<uint32_t>();
+  return sign_ == Sign::Positive ? abs_cmp : 0 <=> abs_cmp;
+}
+
+std::optional<int64_t> BigInt::ToInt64() const {
+  if (!FitsIn<int64_t>()) {
+    return std::nullopt;
   }
 
-  if (carry > 0) {
-    digits_.emplace_back(carry);
+  return ToInt64Saturating();
+}
+
+std::optional<uint64_t> BigInt::ToUint64() const {
+  if (!FitsIn<uint64_t>()) {
+    return std::nullopt;
   }
 
-  return *this;
+  return LowMagnitude();
+}
+
+std::optional<double> BigInt::ToDouble() const {
+  double res = ToDoubleSaturating();
+
+  if (std::isinf(res)) {
+    return std::nullopt;
+  }
+
+  return res;
+}
+
+int64_t BigInt::ToInt64Saturating() const {
+  if (*this > INT64_MAX) {
+    return INT64_MAX;
+  }
+
+  if (*this < INT64_MIN) {
+    return INT64_MIN;
+  }
+
+  uint64_t abs = LowMagnitude();
+  return static_cast<int64_t>(sign_ == Sign::Negative ? 0 - abs : abs);
+}
+
+uint64_t BigInt::ToUint64Saturating() const {
+  if (sign_ == Sign::Negative) {
+    return 0;
+  }
+
+  return digits_.size() > 2 ? UINT64_MAX : LowMagnitude();
+}
+
+double BigInt::ToDoubleSaturating() const {
+  std::size_t bit_len = ::BitLength(digits_);
+
+  if (bit_len <= BitSize<uint64_t>()) {
+    auto abs = static_cast<double>(LowMagnitude());
+    return sign_ == Sign::Negative ? -abs : abs;
+  }
+
+  // Top 64 bits with sticky bit round correctly to 53-bit mantissa
+  std::size_t low = bit_len - BitSize<uint64_t>();
+  double abs = std::ldexp(static_cast<double>(ExtractTopBits(digits_, low)),
+                          static_cast<int>(low));
+
+  return sign_ == Sign::Negative ? -abs : abs;
 }
 
 BigInt& BigInt::operator++() {
@@ -379,12 +1016,17 @@ BigInt BigInt::operator--(int) {
   return copy;
 }
 
-BigInt BigInt::operator-() const {
+BigInt BigInt::operator-() const& {
   BigInt copy = *this;
   copy.sign_ = OppositeSign(sign_);
   return copy;
 }
 
+BigInt BigInt::operator-() && {
+  sign_ = OppositeSign(sign_);
+  return std::move(*this);
+}
+
 std::strong_ordering BigInt::operator<=>(const BigInt& other) const {
   if (sign_ == other.sign_) {
     if (sign_ == Sign::Zero) {
@@ -431,150 +1073,579 @@ BigInt::Sign BigInt::OppositeSign(Sign sign) {
   assert(false);  // unreachable
 }
 
-bool BigInt::IsSameSignAs(int32_t val) {
-  return (val < 0 && sign_ == Sign::Negative) ||
-         (val > 0 && sign_ == Sign::Positive) ||
-         (val == 0 && sign_ == Sign::Zero);
+// Independent lanes eat 2 limbs each per step, so the loop pipelines and
+// vectorizes well
+std::size_t BigInt::Hash() const {
+  std::array<uint64_t, kHashLanes> lanes = kHashSecrets;
+  std::size_t size = digits_.size();
+  std::size_t i = 0;
+
+  for (; i + 2 * kHashLanes <= size; i += 2 * kHashLanes) {
+    for (std::size_t k = 0; k < kHashLanes; ++k) {
+      lanes[k] = HashMix(LoadWord(digits_, i + 2 * k) ^ kHashSecrets[k],
+                         lanes[k] ^ kHashSecrets[(k + 1) % kHashLanes]);
+    }
+  }
+
+  for (; i + 2 <= size; i += 2) {
+    lanes[0] = HashMix(LoadWord(digits_, i) ^ kHashSecrets[1], lanes[0]);
+  }
+
+  uint64_t tail = (i < size) ? digits_[i] : 0;
+  uint64_t head = (size * kHashLanes) | static_cast<uint64_t>(sign_);
+
+  return HashMix(lanes[0] ^ lanes[1] ^ tail, lanes[2] ^ lanes[3] ^ head);
 }
 
 void BigInt::LeftShift(uint32_t digit_num) {
-  if (digit_num == 0) {
+  if (digit_num == 0 || sign_ == Sign::Zero) {
+    return;
+  }
+
+  digits_.insert(digits_.begin(), digit_num, 0);
+}
+
+uint64_t BigInt::BitLength() const {
+  return ::BitLength(digits_);
+}
+
+BigInt& BigInt::operator<<=(uint64_t bits) {
+  if (sign_ == Sign::Zero || bits == 0) {
+    return *this;
+  }
+
+  auto shift = static_cast<uint32_t>(bits % BitSize<uint32_t>());
+  if (shift != 0) {
+    uint32_t carry = 0;
+    for (auto& digit : digits_) {
+      uint64_t cur = (static_cast<uint64_t>(digit) << shift) | carry;
+      digit = static_cast<uint32_t>(cur);
+      carry = static_cast<uint32_t>(cur >> BitSize<uint32_t>());
+    }
+    if (carry != 0) {
+      digits_.push_back(carry);
+    }
+  }
+
+  LeftShift(static_cast<uint32_t>(bits / BitSize<uint32_t>()));
+  return *this;
+}
+
+BigInt& BigInt::operator>>=(uint64_t bits) {
+  if (sign_ == Sign::Zero || bits == 0) {
+    return *this;
+  }
+
+  uint64_t limbs = bits / BitSize<uint32_t>();
+  auto shift = static_cast<uint32_t>(bits % BitSize<uint32_t>());
+  bool inexact = true;
+
+  if (limbs >= digits_.size()) {
+    digits_.clear();
+  } else {
+    auto low_end = digits_.begin() + static_cast<std::ptrdiff_t>(limbs);
+    inexact = std::any_of(digits_.begin(), low_end,
+                          [](uint32_t digit) { return digit != 0; }) ||
+              (*low_end & ((uint32_t{1} << shift) - 1)) != 0;
+
+    digits_.erase(digits_.begin(), low_end);
+    ShiftRightBits(digits_, shift);
+  }
+
+  // Floor: negative values lose one more unit when bits were dropped
+  if (sign_ == Sign::Negative && inexact) {
+    AddMagnitude(digits_, 1);
+  }
+  if (digits_.empty()) {
+    sign_ = Sign::Zero;
+  }
+
+  return *this;
+}
+
+bool BigInt::TestBit(uint64_t pos) const {
+  uint64_t limb = pos / BitSize<uint32_t>();
+  return limb < digits_.size() &&
+         ((digits_[limb] >> (pos % BitSize<uint32_t>())) & 1) != 0;
+}
+
+void BigInt::SetBit(uint64_t pos) {
+  uint64_t limb = pos / BitSize<uint32_t>();
+  if (limb >= digits_.size()) {
+    digits_.resize(limb + 1, 0);
+  }
+
+  digits_[limb] |= uint32_t{1} << (pos % BitSize<uint32_t>());
+  if (sign_ == Sign::Zero) {
+    sign_ = Sign::Positive;
+  }
+}
+
+void BigInt::ClearBit(uint64_t pos) {
+  uint64_t limb = pos / BitSize<uint32_t>();
+  if (limb >= digits_.size()) {
     return;
   }
 
-  // Allocate mem
-  digits_.resize(digits_.size() + digit_num);
+  digits_[limb] &= ~(uint32_t{1} << (pos % BitSize<uint32_t>()));
+  GCDigits(digits_);
+  if (digits_.empty()) {
+    sign_ = Sign::Zero;
+  }
+}
+
+uint64_t BigInt::CountTrailingZeros() const {
+  auto first = std::find_if(digits_.begin(), digits_.end(),
+                            [](uint32_t digit) { return digit != 0; });
+  if (first == digits_.end()) {
+    return 0;
+  }
+
+  return static_cast<uint64_t>(first - digits_.begin()) * BitSize<uint32_t>() +
+         std::countr_zero(*first);
+}
+
+// Limbs paired into 64-bit words, one popcount per word
+[[gnu::always_inline]] static inline uint64_t PopCountWords(
+    const uint32_t* limbs, std::size_t size) {
+  uint64_t count = 0;
+  std::size_t i = 0;
+
+  for (; i + 1 < size; i += 2) {
+    uint64_t word = 0;
+    std::memcpy(&word, limbs + i, sizeof(word));
+    count += std::popcount(word);
+  }
+
+  if (i < size) {
+    count += std::popcount(limbs[i]);
+  }
+
+  return count;
+}
+
+using PopCountFn = uint64_t (*)(const uint32_t*, std::size_t);
+
+#ifdef __x86_64__
+// Baseline x86-64 has no popcnt and std::popcount turns into a bit-twiddling
+// sequence, so the loop is also built for popcnt and for AVX-512 VPOPCNTDQ,
+// and the CPU picks one on first use
+[[gnu::target("popcnt")]] static uint64_t PopCountPopcnt(
+    const uint32_t* limbs, std::size_t size) {
+  return PopCountWords(limbs, size);
+}
+
+// 16 limbs per step, the per-lane counts are summed at the end
+[[gnu::target("avx512f,avx512vpopcntdq,popcnt")]] static uint64_t
+PopCountAvx512(const uint32_t* limbs, std::size_t size) {
+  __m512i sum = _mm512_setzero_si512();
+  std::size_t i = 0;
 
-  // Shift digits
-  for (size_t i = digits_.size() - 1; i >= digit_num; --i) {
-    digits_[i] = digits_[i - digit_num];
+  for (; i + 16 <= size; i += 16) {
+    __m512i block = _mm512_loadu_si512(limbs + i);
+    sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(block));
   }
 
-  // Zerofy smallest digits
-  for (size_t i = 0; i < digit_num; ++i) {
-    digits_[i] = 0;
+  std::array<uint64_t, 8> lanes{};
+  _mm512_storeu_si512(lanes.data(), sum);
+  return std::accumulate(lanes.begin(), lanes.end(),
+                         PopCountWords(limbs + i, size - i));
+}
+
+static PopCountFn ChoosePopCount() {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512vpopcntdq")) {
+    return PopCountAvx512;
+  }
+  if (__builtin_cpu_supports("popcnt")) {
+    return PopCountPopcnt;
   }
+
+  return PopCountWords;
+}
+#else
+static PopCountFn ChoosePopCount() {
+  return PopCountWords;
+}
+#endif
+
+uint64_t BigInt::PopCount() const {
+  static const PopCountFn kPopCount = ChoosePopCount();
+  return kPopCount(digits_.data(), digits_.size());
 }
 
-template <typename It>
-static void PropagateAddCarry(uint64_t carry, It& lhs_it,
-                              std::vector<uint32_t>& lhs) {
-  auto lhs_end = lhs.end();
+double BigInt::Log2Approx() const {
+  if (sign_ == Sign::Zero) {
+    return -std::numeric_limits<double>::infinity();
+  }
+
+  // The top 64 bits, the rest only moves the result past double precision
+  std::size_t size = digits_.size();
+  uint64_t top = digits_[size - 1];
+  uint64_t shift = (size - 1) * BitSize<uint32_t>();
+  if (size >= 2) {
+    top = (top << BitSize<uint32_t>()) | digits_[size - 2];
+    shift -= BitSize<uint32_t>();
+  }
 
-  for (; carry > 0 && lhs_it != lhs_end; ++lhs_it) {
-    carry += *lhs_it;
-    *lhs_it = carry & UINT32_MAX;
+  return std::log2(static_cast<double>(top)) + static_cast<double>(shift);
+}
+
+BigInt::Sign operator*(const BigInt::Sign& lhs, const BigInt::Sign& rhs) {
+  if (lhs == BigInt::Sign::Zero || rhs == BigInt::Sign::Zero) {
+    return BigInt::Sign::Zero;
+  }
+
+  return lhs == rhs ? BigInt::Sign::Positive : BigInt::Sign::Negative;
+}
+
+static void AddBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out) {
+  // Sizes are saved before resize, as `out` may be one of the inputs
+  const auto& longer = (lhs.size() >= rhs.size()) ? lhs : rhs;
+  std::size_t common = std::min(lhs.size(), rhs.size());
+  std::size_t longer_size = longer.size();
+
+  // One spare limb for the final carry
+  out.reserve(longer_size + 1);
+  out.resize(longer_size);
+
+  uint64_t carry = 0;
+
+  for (std::size_t i = 0; i < common; ++i) {
+    carry += static_cast<uint64_t>(lhs[i]) + rhs[i];
+    out[i] = carry & UINT32_MAX;
+    carry >>= BitSize<uint32_t>();
+  }
+
+  for (std::size_t i = common; i < longer_size; ++i) {
+    carry += longer[i];
+    out[i] = carry & UINT32_MAX;
     carry >>= BitSize<uint32_t>();
   }
+
   if (carry != 0) {
-    assert(lhs_it == lhs_end);
-    lhs.emplace_back(carry);
+    out.emplace_back(carry);
+  }
+}
+
+static void SubBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out) {
+  std::size_t lhs_size = lhs.size();
+  std::size_t rhs_size = rhs.size();
+  assert(lhs_size >= rhs_size);
+
+  out.resize(lhs_size);
+  uint64_t borrow = 0;
+
+  for (std::size_t i = 0; i < lhs_size; ++i) {
+    if (i >= rhs_size && borrow == 0 && &out == &lhs) {
+      break;  // the rest is already in place
+    }
+
+    uint64_t sub = (i < rhs_size ? rhs[i] : 0) + borrow;
+    uint64_t digit = lhs[i];
+
+    borrow = (digit < sub) ? 1 : 0;
+    out[i] = (borrow << BitSize<uint32_t>()) + digit - sub;
+  }
+
+  assert(borrow == 0);
+  GCDigits(out);
+}
+
+using LimbSpan = std::span<const uint32_t>;
+
+// Karatsuba recursion needs at least this many limbs to shrink
+constexpr std::size_t kMinKaratsubaSize = 4;
+
+// out[0, n + m) = lhs * rhs
+static void MulSchool(LimbSpan lhs, LimbSpan rhs, uint32_t* out) {
+  std::fill_n(out, lhs.size() + rhs.size(), 0);
+
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    uint64_t carry = 0;
+
+    // (2^32 - 1)^2 + 2 * (2^32 - 1) still fits in uint64_t
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      carry += static_cast<uint64_t>(lhs[i]) * rhs[j] + out[i + j];
+      out[i + j] = carry & UINT32_MAX;
+      carry >>= BitSize<uint32_t>();
+    }
+
+    out[i + rhs.size()] = carry;
   }
 }
 
-// You can look at the code documentation in the git history, it didn't fit in
-// clang tidy limits
-static void AddBuffers(std::vector<uint32_t>& lhs,
-                       const std::vector<uint32_t>& rhs) {
+// out[0, 2n) = val^2, off-diagonal products are computed once and doubled
+static void SqrSchool(LimbSpan val, uint32_t* out) {
+  std::size_t size = val.size();
+  std::fill_n(out, 2 * size, 0);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = i + 1; j < size; ++j) {
+      carry += static_cast<uint64_t>(val[i]) * val[j] + out[i + j];
+      out[i + j] = carry & UINT32_MAX;
+      carry >>= BitSize<uint32_t>();
+    }
+    out[i + size] = carry;
+  }
+
+  uint32_t top_bit = 0;
+  for (std::size_t k = 0; k < 2 * size; ++k) {
+    uint32_t cur = out[k];
+    out[k] = (cur << 1) | top_bit;
+    top_bit = cur >> (BitSize<uint32_t>() - 1);
+  }
+
   uint64_t carry = 0;
-  lhs.reserve(rhs.size());
-
-  // Precompute iterators
-  auto lhs_it = lhs.begin();
-  auto lhs_end = lhs.end();
-  auto rhs_it = rhs.cbegin();
-  auto rhs_end = rhs.cend();
-
-  // Process common
-  for (; lhs_it < lhs_end && rhs_it < rhs_end; ++lhs_it, ++rhs_it) {
-    carry =
-        static_cast<uint64_t>(*lhs_it) + static_cast<uint64_t>(*rhs_it) + carry;
-    *lhs_it = carry & UINT32_MAX;
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t square = static_cast<uint64_t>(val[i]) * val[i];
+    carry += static_cast<uint64_t>(out[2 * i]) + (square & UINT32_MAX);
+    out[2 * i] = carry & UINT32_MAX;
+    carry >>= BitSize<uint32_t>();
+    carry += static_cast<uint64_t>(out[2 * i + 1]) +
+             (square >> BitSize<uint32_t>());
+    out[2 * i + 1] = carry & UINT32_MAX;
     carry >>= BitSize<uint32_t>();
   }
+}
 
-  if (rhs_it == rhs_end) {
-    PropagateAddCarry(carry, lhs_it, lhs);
-    return;
-  }
+// out[0, size) = lhs + rhs, zero padded, size > max(lhs, rhs)
+static void AddLimbs(LimbSpan lhs, LimbSpan rhs, uint32_t* out,
+                     std::size_t size) {
+  uint64_t carry = 0;
 
-  for (; rhs_it != rhs_end; ++rhs_it) {
-    carry += *rhs_it;
-    lhs.emplace_back(carry & UINT32_MAX);
+  for (std::size_t i = 0; i < size; ++i) {
+    carry += (i < lhs.size() ? lhs[i] : 0ULL) + (i < rhs.size() ? rhs[i] : 0);
+    out[i] = carry & UINT32_MAX;
     carry >>= BitSize<uint32_t>();
   }
 }
 
-// Return: carry
-template <typename InputIt, typename OutputIt>
-static uint64_t SubstracCommon(InputIt& lhs_it, const InputIt& lhs_end,
-                               InputIt& rhs_it, const InputIt& rhs_end,
-                               OutputIt& out_it) {
+// acc[0, size) += val, the sum must fit
+static void AddLimbsInPlace(uint32_t* acc, std::size_t size, LimbSpan val) {
   uint64_t carry = 0;
 
-  for (; lhs_it < lhs_end && rhs_it < rhs_end; ++lhs_it, ++rhs_it, ++out_it) {
-    carry += *rhs_it;
-    uint64_t digit = *lhs_it;
+  for (std::size_t i = 0; i < size && (i < val.size() || carry > 0); ++i) {
+    carry += static_cast<uint64_t>(acc[i]) + (i < val.size() ? val[i] : 0);
+    acc[i] = carry & UINT32_MAX;
+    carry >>= BitSize<uint32_t>();
+  }
+
+  assert(carry == 0);
+}
 
-    if (digit >= carry) {
-      *out_it = digit - carry;
-      carry = 0;
-    } else {
-      *out_it = UINT32_MAX - carry + digit + 1;
-      carry = 1;
-    }
+// acc[0, size) -= val, the difference must be non-negative
+static void SubLimbsInPlace(uint32_t* acc, std::size_t size, LimbSpan val) {
+  uint64_t borrow = 0;
+
+  for (std::size_t i = 0; i < size && (i < val.size() || borrow > 0); ++i) {
+    uint64_t sub = (i < val.size() ? val[i] : 0) + borrow;
+    borrow = (acc[i] < sub) ? 1 : 0;
+    acc[i] = (borrow << BitSize<uint32_t>()) + acc[i] - sub;
+  }
+
+  assert(borrow == 0);
+}
+
+// Upper bound of scratch limbs MulLimbs needs for operands up to `size`
+static std::size_t MulScratchSize(std::size_t size) {
+  if (size < kMinKaratsubaSize) {
+    return 0;
   }
 
-  return carry;
+  std::size_t sum_size = size - size / 2 + 1;
+  return 4 * sum_size + MulScratchSize(sum_size);
 }
 
-[[nodiscard("You should check for sign = zero")]] static BigInt::Sign
-SubBuffersTo(const std::vector<uint32_t>& lhs, const std::vector<uint32_t>& rhs,
-             std::vector<uint32_t>& out) {
-  out.reserve(lhs.size());
+static void MulLimbs(LimbSpan lhs, LimbSpan rhs, uint32_t* out,
+                     uint32_t* scratch);
+
+// lhs >= rhs > lhs / 2. Operands are split at half of lhs:
+// lhs * rhs = z0 + (z1 - z0 - z2) * B^half + z2 * B^(2 * half)
+static void KaratsubaMul(LimbSpan lhs, LimbSpan rhs, uint32_t* out,
+                         uint32_t* scratch) {
+  bool square = lhs.data() == rhs.data() && lhs.size() == rhs.size();
+  std::size_t half = lhs.size() / 2;
+  std::size_t out_size = lhs.size() + rhs.size();
+
+  MulLimbs(lhs.first(half), rhs.first(half), out, scratch);
+  MulLimbs(lhs.subspan(half), rhs.subspan(half), out + 2 * half, scratch);
 
-  auto lhs_it = lhs.begin();
-  auto rhs_it = rhs.begin();
-  auto out_it = out.begin();
-  auto lhs_end = lhs.end();  // it would be constant if there were no clang tidy
-  auto rhs_end = rhs.end();  // it would be constant if there were no clang tidy
+  std::size_t sum_size = lhs.size() - half + 1;
+  uint32_t* lhs_sum = scratch;
+  uint32_t* rhs_sum = square ? lhs_sum : scratch + sum_size;
+  uint32_t* mid = scratch + 2 * sum_size;
 
-  // Substract common phase
-  uint64_t carry = SubstracCommon(lhs_it, lhs_end, rhs_it, rhs_end, out_it);
+  AddLimbs(lhs.first(half), lhs.subspan(half), lhs_sum, sum_size);
+  if (!square) {
+    AddLimbs(rhs.first(half), rhs.subspan(half), rhs_sum, sum_size);
+  }
+
+  MulLimbs({lhs_sum, sum_size}, {rhs_sum, sum_size}, mid,
+           scratch + 4 * sum_size);
 
-  // Propagate carry
-  PropagateSubCarry(carry, lhs_it, out_it);
+  SubLimbsInPlace(mid, 2 * sum_size, {out, 2 * half});
+  SubLimbsInPlace(mid, 2 * sum_size, {out + 2 * half, out_size - 2 * half});
+
+  // Middle term is below B^(out_size - half), its top limbs are zero
+  std::size_t mid_size = std::min(2 * sum_size, out_size - half);
+  AddLimbsInPlace(out + half, out_size - half, {mid, mid_size});
+}
 
+// lhs >= 2 * rhs: multiply rhs-sized blocks of lhs and accumulate
+static void MulChopped(LimbSpan lhs, LimbSpan rhs, uint32_t* out,
+                       uint32_t* scratch) {
+  std::size_t out_size = lhs.size() + rhs.size();
+  uint32_t* block_out = scratch;
+  std::fill_n(out, out_size, 0);
+
+  for (std::size_t pos = 0; pos < lhs.size(); pos += rhs.size()) {
+    auto block = lhs.subspan(pos, std::min(rhs.size(), lhs.size() - pos));
+    MulLimbs(block, rhs, block_out, scratch + 2 * rhs.size());
+    AddLimbsInPlace(out + pos, out_size - pos,
+                    {block_out, block.size() + rhs.size()});
+  }
+}
+
+// out[0, n + m) = lhs * rhs, picks algorithm by operand sizes
+static void MulLimbs(LimbSpan lhs, LimbSpan rhs, uint32_t* out,
+                     uint32_t* scratch) {
+  if (lhs.size() < rhs.size()) {
+    std::swap(lhs, rhs);
+  }
+
+  bool square = lhs.data() == rhs.data() && lhs.size() == rhs.size();
+  BigIntThresholds thresholds = GetThresholds();
+  std::size_t threshold = std::max(
+      square ? thresholds.karatsuba_sqr : thresholds.karatsuba_mul,
+      kMinKaratsubaSize);
+
+  if (rhs.size() < threshold) {
+    square ? SqrSchool(lhs, out) : MulSchool(lhs, rhs, out);
+  } else if (lhs.size() >= 2 * rhs.size()) {
+    MulChopped(lhs, rhs, out, scratch);
+  } else {
+    KaratsubaMul(lhs, rhs, out, scratch);
+  }
+}
+
+static void MulBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& out) {
+  assert(&out != &lhs && &out != &rhs);
+  static thread_local Limbs scratch;
+
+  out.resize(lhs.size() + rhs.size());
+  scratch.resize(MulScratchSize(std::max(lhs.size(), rhs.size())));
+
+  MulLimbs(lhs, rhs, out.data(), scratch.data());
   GCDigits(out);
+  ReleaseScratch(scratch);
+}
+
+// out = digits << shift, shift < 32, out is one limb longer than digits
+static void ShiftBitsTo(const Limbs& digits, int shift, Limbs& out) {
+  out.resize(digits.size() + 1);
+  uint64_t carry = 0;
 
-  return out.empty() ? BigInt::Sign::Zero : BigInt::Sign::Positive;
+  for (std::size_t i = 0; i < digits.size(); ++i) {
+    uint64_t cur = static_cast<uint64_t>(digits[i]) << shift;
+    out[i] = (cur & UINT32_MAX) | carry;
+    carry = cur >> BitSize<uint32_t>();
+  }
+
+  out.back() = carry;
 }
 
-BigInt::Sign operator*(const BigInt::Sign& lhs, const BigInt::Sign& rhs) {
-  if (lhs == BigInt::Sign::Zero || rhs == BigInt::Sign::Zero) {
-    return BigInt::Sign::Zero;
+// un[j..j+n] += vn, ignoring the carry out of the top limb
+static void AddBackStep(Limbs& un, const Limbs& vn, std::size_t j) {
+  uint64_t carry = 0;
+
+  for (std::size_t i = 0; i < vn.size(); ++i) {
+    carry += static_cast<uint64_t>(un[i + j]) + vn[i];
+    un[i + j] = carry & UINT32_MAX;
+    carry >>= BitSize<uint32_t>();
   }
 
-  return lhs == rhs ? BigInt::Sign::Positive : BigInt::Sign::Negative;
+  un[j + vn.size()] += carry;
 }
 
-// breaking naming due to clang-tidy: readability-suspicious-call-argument
-static BigInt::Sign SubBuffers(std::vector<uint32_t>& left_op,
-                               const std::vector<uint32_t>& right_op) {
-  // lhs >= rhs
-  if (CompareBuffers(left_op, right_op) != std::strong_ordering::less) {
-    auto sign = SubBuffersTo(left_op, right_op, left_op);
-    return sign * BigInt::Sign::Positive;
+// One step of Knuth's algorithm D: un[j..j+n] -= q * vn, returns q
+static uint32_t DivStep(Limbs& un, const Limbs& vn, std::size_t j) {
+  constexpr uint64_t kBase = 1ULL << BitSize<uint32_t>();
+  std::size_t n = vn.size();
+
+  uint64_t top = (static_cast<uint64_t>(un[j + n]) << BitSize<uint32_t>()) |
+                 un[j + n - 1];
+  uint64_t qhat = top / vn[n - 1];
+  uint64_t rhat = top % vn[n - 1];
+
+  // At most two corrections, see TAOCP 4.3.1
+  while (qhat >= kBase ||
+         qhat * vn[n - 2] > ((rhat << BitSize<uint32_t>()) | un[j + n - 2])) {
+    --qhat;
+    rhat += vn[n - 1];
+    if (rhat >= kBase) {
+      break;
+    }
+  }
+
+  int64_t borrow = 0;
+  uint64_t carry = 0;
+
+  for (std::size_t i = 0; i <= n; ++i) {
+    uint64_t prod = (i < n ? qhat * vn[i] : 0) + carry;
+    carry = prod >> BitSize<uint32_t>();
+
+    int64_t cur = static_cast<int64_t>(un[i + j]) - borrow -
+                  static_cast<int64_t>(prod & UINT32_MAX);
+    un[i + j] = static_cast<uint32_t>(cur);
+    borrow = (cur < 0) ? 1 : 0;
   }
 
-  /* else */  // due to cringe clang-tidy: readability-else-after-return
+  // qhat was still one too large
+  if (borrow != 0) {
+    BIGINT_STATS_DIV_ADD_BACK();
+    --qhat;
+    AddBackStep(un, vn, j);
+  }
 
-  auto sign = SubBuffersTo(right_op, left_op, left_op);
-  return sign * BigInt::Sign::Negative;
+  return qhat;
 }
 
-static std::strong_ordering CompareBuffers(const std::vector<uint32_t>& lhs,
-                                           const std::vector<uint32_t>& rhs) {
+static void DivBuffersTo(const Limbs& lhs, const Limbs& rhs, Limbs& quot,
+                         Limbs& rem) {
+  // Normalized copies, also make aliased outputs safe to write
+  static thread_local Limbs un;
+  static thread_local Limbs vn;
+
+  int shift = std::countl_zero(rhs.back());
+  ShiftBitsTo(lhs, shift, un);
+  ShiftBitsTo(rhs, shift, vn);
+  vn.pop_back();
+
+  std::size_t n = vn.size();
+  quot.assign(un.size() - n, 0);
+
+  BIGINT_STATS_DIV_STEPS(quot.size());
+  for (std::size_t j = quot.size(); j-- > 0;) {
+    quot[j] = DivStep(un, vn, j);
+  }
+
+  rem.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    uint64_t pair =
+        (static_cast<uint64_t>(un[i + 1]) << BitSize<uint32_t>()) | un[i];
+    rem[i] = (pair >> shift) & UINT32_MAX;
+  }
+
+  GCDigits(quot);
+  GCDigits(rem);
+  ReleaseScratch(un);
+  ReleaseScratch(vn);
+}
+
+static std::strong_ordering CompareBuffers(const Limbs& lhs, const Limbs& rhs) {
   if (lhs.size() > rhs.size()) {
     return std::strong_ordering::greater;
   }
@@ -587,36 +1658,77 @@ static std::strong_ordering CompareBuffers(const std::vector<uint32_t>& lhs,
                                                 rhs.crbegin(), rhs.crend());
 }
 
-std::ostream& operator<<(std::ostream& stream, BigInt val) {
-  BigInt base(kDecBase);
-  std::string buf;
+std::ostream& operator<<(std::ostream& stream, const BigInt& val) {
+  auto basefield = stream.flags() & std::ios_base::basefield;
 
-  if (val.sign_ == BigInt::Sign::Zero) {
-    stream << "0";
-    return stream;
+  if (basefield == std::ios_base::hex) {
+    return stream << val.ToString(16);
   }
 
-  bool was_negative = (val.sign_ == BigInt::Sign::Negative);
-
-  while (val) {
-    buf += '0' + (val % base).digits_[0];
-    val /= base;
+  if (basefield == std::ios_base::oct) {
+    return stream << val.ToString(8);
   }
 
-  if (was_negative) {
-    buf += '-';
+  return stream << val.ToString();
+}
+
+std::istream& operator>>(std::istream& stream, BigInt& val) {
+  auto basefield = stream.flags() & std::ios_base::basefield;
+
+  if (basefield == std::ios_base::hex) {
+    return ReadBigInt(stream, val, 16);
   }
 
-  std::copy(buf.crbegin(), buf.crend(), std::ostream_iterator<char>(stream));
+  if (basefield == std::ios_base::oct) {
+    return ReadBigInt(stream, val, 8);
+  }
 
-  return stream;
+  return ReadBigInt(stream, val, kDecBase);
 }
 
-std::istream& operator>>(std::istream& stream, BigInt& val) {
-  std::string buf;
-  stream >> buf;
+// Reads straight from the streambuf, which is already chunk-buffered
+std::istream& ReadBigInt(std::istream& stream, BigInt& val, int radix) {
+  assert(radix >= kMinRadix && radix <= kMaxRadix);
+
+  std::istream::sentry sentry(stream);
+  if (!sentry) {
+    return stream;
+  }
 
-  val = BigInt(buf);
+  using Traits = std::istream::traits_type;
+  std::streambuf* buf = stream.rdbuf();
+  Traits::int_type chr = buf->sgetc();
+
+  BigInt::Sign sign = BigInt::Sign::Positive;
+  if (chr == '-' || chr == '+') {
+    sign = (chr == '-') ? BigInt::Sign::Negative : BigInt::Sign::Positive;
+    chr = buf->snextc();
+  }
+
+  DigitAccumulator acc(static_cast<uint32_t>(radix));
+  std::size_t count = 0;
+
+  for (; !Traits::eq_int_type(chr, Traits::eof()) &&
+         acc.Push(Traits::to_char_type(chr));
+       chr = buf->snextc()) {
+    ++count;
+  }
+
+  // Token must end on whitespace or eof, trailing garbage is left unread
+  bool at_eof = Traits::eq_int_type(chr, Traits::eof());
+  bool malformed =
+      count == 0 ||
+      (!at_eof && !std::isspace(Traits::to_char_type(chr), stream.getloc()));
+
+  acc.Finish(val.digits_);
+  BIGINT_STATS_OP(Parse, val.digits_.size());
+  val.sign_ = (val.digits_.empty() || malformed) ? BigInt::Sign::Zero : sign;
+
+  if (malformed) {
+    val.digits_.clear();
+  }
 
+  auto state = at_eof ? std::ios_base::eofbit : std::ios_base::goodbit;
+  stream.setstate(malformed ? state | std::ios_base::failbit : state);
   return stream;
 }
@@ -1,9 +1,37 @@
+#pragma once
+
 #include <compare>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <istream>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <ostream>
+#include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
+#include <version>
+
+#include "big_integer_stats.hpp"
+
+#ifdef __cpp_lib_format
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <format>
+#endif
+
+__extension__ using Int128 = __int128;
+__extension__ using UInt128 = unsigned __int128;
+
+// Native integers that fit into one 64-bit machine word
+template <typename T>
+concept NativeInt =
+    std::integral<T> && !std::same_as<T, bool> && sizeof(T) <= sizeof(uint64_t);
 
 class BigInt {
  public:
@@ -22,11 +50,45 @@ class BigInt {
 
   // constructing from other types
   BigInt(int64_t);
+  BigInt(uint64_t);
+  BigInt(Int128);
+  BigInt(UInt128);
   explicit BigInt(std::string_view);
 
+  // Radix in [2, 36]. Power-of-two radixes are linear bit repacking, others
+  // go limb-sized chunk at a time, divide and conquer above the
+  // radix_conversion threshold. Letters are lowercase on output and
+  // case-insensitive on input, optional leading '-' or '+'.
+  std::string ToString(int radix = 10) const;
+  static std::optional<BigInt> FromString(std::string_view input,
+                                          int radix = 10);
+
+  // Other native integers are widened to the 64-bit ctors
+  template <NativeInt T>
+  BigInt(T val)
+      : BigInt(static_cast<std::conditional_t<std::is_signed_v<T>, int64_t,
+                                              uint64_t>>(val)) {}
+
   // Some convertions
   explicit operator bool() const { return sign_ != Sign::Zero; }
 
+  // Checked convertions: std::nullopt when value is out of range
+  std::optional<int64_t> ToInt64() const;
+  std::optional<uint64_t> ToUint64() const;
+  std::optional<double> ToDouble() const;
+
+  // Saturating convertions: clamp to the nearest representable value,
+  // ToDoubleSaturating gives +-inf on overflow
+  int64_t ToInt64Saturating() const;
+  uint64_t ToUint64Saturating() const;
+  double ToDoubleSaturating() const;
+
+  template <NativeInt T>
+  bool FitsIn() const {
+    return *this >= std::numeric_limits<T>::min() &&
+           *this <= std::numeric_limits<T>::max();
+  }
+
   // Math
   BigInt& operator+=(const BigInt& other);
   BigInt& operator-=(const BigInt& other);
@@ -34,17 +96,40 @@ class BigInt {
   BigInt& operator/=(const BigInt& other);
   BigInt& operator%=(const BigInt& other);
 
-  // Int Operations
-  BigInt& operator+=(int32_t other);
-  BigInt& operator-=(int32_t other);
-  BigInt& operator*=(int32_t other);
+  // Native int operations, no temporary BigInt is created
+  template <NativeInt T>
+  BigInt& operator+=(T other) {
+    return AddNative(NativeSign(other), NativeAbs(other));
+  }
+
+  template <NativeInt T>
+  BigInt& operator-=(T other) {
+    return AddNative(OppositeSign(NativeSign(other)), NativeAbs(other));
+  }
+
+  template <NativeInt T>
+  BigInt& operator*=(T other) {
+    return MulNative(NativeSign(other), NativeAbs(other));
+  }
+
+  // Division by zero is UB, same as for native ints
+  template <NativeInt T>
+  BigInt& operator/=(T other) {
+    return DivNative(NativeSign(other), NativeAbs(other));
+  }
+
+  template <NativeInt T>
+  BigInt& operator%=(T other) {
+    return ModNative(NativeAbs(other));
+  }
 
   // Small math
   BigInt& operator++();
   BigInt& operator--();
   BigInt operator++(int);
   BigInt operator--(int);
-  BigInt operator-() const;
+  BigInt operator-() const&;
+  BigInt operator-() &&;  // reuses limbs of a temporary
 
   // Absurd & costly
   BigInt operator+() = delete;
@@ -53,25 +138,309 @@ class BigInt {
   std::strong_ordering operator<=>(const BigInt& other) const;
   bool operator==(const BigInt& other) const;
 
+  template <NativeInt T>
+  std::strong_ordering operator<=>(T other) const {
+    return CmpNative(NativeSign(other), NativeAbs(other));
+  }
+
+  template <NativeInt T>
+  bool operator==(T other) const {
+    return CmpNative(NativeSign(other), NativeAbs(other)) ==
+           std::strong_ordering::equal;
+  }
+
+  // Consistent with operator==, not stable between library versions
+  std::size_t Hash() const;
+
   void LeftShift(uint32_t digit_num);
 
+  // Bits in abs(*this), 0 for zero
+  uint64_t BitLength() const;
+  std::size_t LimbCount() const { return digits_.size(); }
+
+  // Bit access to abs(*this), the sign is kept (zero becomes positive on
+  // SetBit). Limbs are only added or dropped at the top.
+  bool TestBit(uint64_t pos) const;
+  void SetBit(uint64_t pos);
+  void ClearBit(uint64_t pos);
+
+  // Of abs(*this), both are 0 for zero
+  uint64_t CountTrailingZeros() const;
+  uint64_t PopCount() const;
+
+  // log2(abs(*this)) from the top 64 bits, -inf for zero
+  double Log2Approx() const;
+
+  // Shifts by bits, >>= rounds toward -inf like for native ints
+  BigInt& operator<<=(uint64_t bits);
+  BigInt& operator>>=(uint64_t bits);
+
+  // abs(*this) mod divisor in one pass over the limbs, without copying
+  uint32_t ModLimb(uint32_t divisor) const;
+
+  // Capacity in limbs, lets hot loops run without touching the allocator
+  void Reserve(std::size_t limbs) { digits_.reserve(limbs); }
+  void ShrinkToFit() { digits_.shrink_to_fit(); }
+  std::size_t Capacity() const { return digits_.capacity(); }
+
  private:
-  BigInt(Sign sign, std::vector<uint32_t> digits)
+  BigInt(Sign sign, Limbs digits)
       : sign_(sign), digits_(std::move(digits)) {}
+  BigInt(Sign sign, UInt128 abs);
 
   static Sign OppositeSign(Sign);
-  bool IsSameSignAs(int32_t);
 
-  BigInt GetDivDigit(const BigInt& other) const;
-  uint64_t GetHead(int64_t start_index = 0) const;
-  BigInt DivOneIter(const BigInt& other);
+  template <NativeInt T>
+  static constexpr Sign NativeSign(T val) {
+    if (val == 0) {
+      return Sign::Zero;
+    }
+    return val > 0 ? Sign::Positive : Sign::Negative;
+  }
+
+  // Unsigned wrap-around gives correct abs even for INT64_MIN
+  template <NativeInt T>
+  static constexpr uint64_t NativeAbs(T val) {
+    auto wide = static_cast<uint64_t>(val);
+    return val < 0 ? 0 - wide : wide;
+  }
 
-  friend std::ostream& operator<<(std::ostream& stream, BigInt val);
+  void AssignMagnitude(UInt128 abs);
+  uint64_t LowMagnitude() const;
+
+  BigInt& AddNative(Sign sign, uint64_t abs);
+  BigInt& MulNative(Sign sign, uint64_t abs);
+  BigInt& DivNative(Sign sign, uint64_t abs);
+  BigInt& ModNative(uint64_t abs);
+  uint64_t DivModMagnitude(uint64_t divisor);
+  std::strong_ordering CmpNative(Sign sign, uint64_t abs) const;
+
+  static void AddSigned(BigInt& dst, const BigInt& lhs, const BigInt& rhs,
+                        Sign rhs_sign);
+
+  friend std::ostream& operator<<(std::ostream& stream, const BigInt& val);
   friend Sign operator*(const Sign& lhs, const Sign& rhs);
 
+  friend class BigIntAccumulator;
+  friend class MontgomeryContext;
+  friend class BigRational;
+  friend class BigIntRandom;
+  friend class BigIntFile;
+
+  friend std::istream& ReadBigInt(std::istream& stream, BigInt& val,
+                                  int radix);
+
+  friend void Add(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+  friend void Sub(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+  friend void Mul(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+  friend void DivMod(BigInt& quot, BigInt& rem, const BigInt& lhs,
+                     const BigInt& rhs);
+
   Sign sign_{Sign::Zero};
-  std::vector<uint32_t> digits_;
+  Limbs digits_;
+};
+
+template <>
+struct std::hash<BigInt> {
+  std::size_t operator()(const BigInt& val) const noexcept {
+    return val.Hash();
+  }
+};
+
+// Immutable BigInt with precomputed hash, for hot hash-container keys
+class HashedBigInt {
+ public:
+  explicit HashedBigInt(BigInt value)
+      : value_(std::move(value)), hash_(value_.Hash()) {}
+
+  const BigInt& Value() const { return value_; }
+  std::size_t Hash() const { return hash_; }
+
+  bool operator==(const HashedBigInt& other) const {
+    return hash_ == other.hash_ && value_ == other.value_;
+  }
+
+ private:
+  BigInt value_;
+  std::size_t hash_;
+};
+
+template <>
+struct std::hash<HashedBigInt> {
+  std::size_t operator()(const HashedBigInt& val) const noexcept {
+    return val.Hash();
+  }
+};
+
+#ifdef __cpp_lib_format
+// Spec: [[fill]align][#][0][width][b|o|d|x|X], as for built-in integers
+// but with a plain number for width. '#' adds the 0b/0/0x (0X for 'X')
+// prefix after the sign, none for decimal, '0' pads with zeros after the
+// prefix. Fill, align and width go to the std::string_view formatter,
+// right-aligned by default.
+template <>
+struct std::formatter<BigInt> {
+  constexpr auto parse(std::format_parse_context& ctx) {
+    const auto* it = ctx.begin();
+    const auto* end = ctx.end();
+    std::array<char, 32> padding{};
+    std::size_t padding_len = 0;
+    bool aligned = true;
+
+    auto is_align = [](char chr) {
+      return chr == '<' || chr == '^' || chr == '>';
+    };
+
+    if (end - it >= 2 && is_align(it[1]) && *it != '{' && *it != '}') {
+      padding[padding_len++] = *it++;
+      padding[padding_len++] = *it++;
+    } else if (it != end && is_align(*it)) {
+      padding[padding_len++] = *it++;
+    } else {
+      padding[padding_len++] = '>';
+      aligned = false;
+    }
+
+    if (it != end && *it == '#') {
+      prefix_ = true;
+      ++it;
+    }
+
+    // Like for built-in integers, an explicit align turns '0' off
+    if (it != end && *it == '0') {
+      zero_pad_ = !aligned;
+      ++it;
+    }
+
+    for (; it != end && *it >= '0' && *it <= '9'; ++it) {
+      if (padding_len == padding.size()) {
+        throw std::format_error("BigInt format width is too long");
+      }
+      padding[padding_len++] = *it;
+      width_ = width_ * 10 + static_cast<std::size_t>(*it - '0');
+    }
+
+    if (it != end && *it != '}') {
+      switch (*it) {
+        case 'b':
+          radix_ = 2;
+          break;
+        case 'o':
+          radix_ = 8;
+          break;
+        case 'd':
+          radix_ = 10;
+          break;
+        case 'x':
+          radix_ = 16;
+          break;
+        case 'X':
+          radix_ = 16;
+          upper_ = true;
+          break;
+        default:
+          throw std::format_error("invalid BigInt format spec");
+      }
+      ++it;
+    }
+
+    if (it != end && *it != '}') {
+      throw std::format_error("invalid BigInt format spec");
+    }
+
+    std::format_parse_context padding_ctx(
+        std::string_view(padding.data(), padding_len));
+    padding_.parse(padding_ctx);
+    return it;
+  }
+
+  auto format(const BigInt& val, std::format_context& ctx) const {
+    std::string str = val.ToString(radix_);
+
+    if (upper_) {
+      std::transform(str.begin(), str.end(), str.begin(),
+                     [](char chr) { return std::toupper(chr); });
+    }
+
+    std::size_t pos = (str.front() == '-') ? 1 : 0;
+    std::string_view prefix;
+    if (!prefix_ || radix_ == 10) {
+      prefix = "";
+    } else if (radix_ == 2) {
+      prefix = "0b";
+    } else if (radix_ == 8) {
+      prefix = (str == "0") ? "" : "0";
+    } else {
+      prefix = upper_ ? "0X" : "0x";
+    }
+    str.insert(pos, prefix);
+    pos += prefix.size();
+
+    if (zero_pad_ && str.size() < width_) {
+      str.insert(pos, width_ - str.size(), '0');
+    }
+
+    return padding_.format(str, ctx);
+  }
+
+ private:
+  std::formatter<std::string_view> padding_;
+  std::size_t width_ = 0;
+  int radix_ = 10;
+  bool prefix_ = false;
+  bool upper_ = false;
+  bool zero_pad_ = false;
 };
+#endif
+
+// Immutable shared handle for large read-mostly values (moduli, cached
+// constants). Copies are O(1) with an atomic refcount, and since the value
+// is never modified, concurrent readers need no synchronization.
+class BigIntConst {
+ public:
+  BigIntConst() : value_(SharedZero()) {}
+  BigIntConst(BigInt value)
+      : value_(std::make_shared<const BigInt>(std::move(value))) {}
+
+  const BigInt& Get() const { return *value_; }
+  operator const BigInt&() const { return *value_; }
+  const BigInt& operator*() const { return *value_; }
+  const BigInt* operator->() const { return value_.get(); }
+
+  // Deep copy for mutation
+  BigInt ToMutable() const { return *value_; }
+
+  bool operator==(const BigIntConst& other) const {
+    return value_ == other.value_ || *value_ == *other.value_;
+  }
+
+ private:
+  static const std::shared_ptr<const BigInt>& SharedZero() {
+    static const auto kZero = std::make_shared<const BigInt>();
+    return kZero;
+  }
+
+  std::shared_ptr<const BigInt> value_;
+};
+
+template <>
+struct std::hash<BigIntConst> {
+  std::size_t operator()(const BigIntConst& val) const noexcept {
+    return val->Hash();
+  }
+};
+
+// Three-operand arithmetic: the result is written into an existing BigInt,
+// reusing its capacity. Destination may alias any of the operands.
+void Add(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+void Sub(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+void Mul(BigInt& dst, const BigInt& lhs, const BigInt& rhs);
+
+// Truncating division, remainder takes the sign of lhs. quot != rem
+void DivMod(BigInt& quot, BigInt& rem, const BigInt& lhs, const BigInt& rhs);
+
+// Non-negative, Gcd(0, 0) = 0
+BigInt Gcd(const BigInt& lhs, const BigInt& rhs);
 
 static BigInt operator""_bi(const char* val, std::size_t len) {
   return BigInt(std::string_view(val, len));
@@ -92,44 +461,87 @@ static BigInt operator*(BigInt self, const BigInt& other) {
   return self;
 }
 
-static BigInt operator+(BigInt self, int32_t other) {
-  self += other;
+static BigInt operator/(BigInt self, const BigInt& other) {
+  self /= other;
   return self;
 }
 
-static BigInt operator-(BigInt self, int32_t other) {
-  self -= other;
+static BigInt operator%(BigInt self, const BigInt& other) {
+  self %= other;
   return self;
 }
 
-static BigInt operator*(BigInt self, int32_t other) {
-  self *= other;
+static BigInt operator<<(BigInt self, uint64_t bits) {
+  self <<= bits;
   return self;
 }
 
-static BigInt operator+(int32_t other, BigInt self) {
+static BigInt operator>>(BigInt self, uint64_t bits) {
+  self >>= bits;
+  return self;
+}
+
+template <NativeInt T>
+static BigInt operator+(BigInt self, T other) {
   self += other;
   return self;
 }
 
-static BigInt operator-(int32_t other, BigInt self) {
+template <NativeInt T>
+static BigInt operator-(BigInt self, T other) {
   self -= other;
   return self;
 }
 
-static BigInt operator*(int32_t other, BigInt self) {
+template <NativeInt T>
+static BigInt operator*(BigInt self, T other) {
   self *= other;
   return self;
 }
 
-static BigInt operator/(BigInt self, const BigInt& other) {
+template <NativeInt T>
+static BigInt operator/(BigInt self, T other) {
   self /= other;
   return self;
 }
 
-static BigInt operator%(BigInt self, const BigInt& other) {
+template <NativeInt T>
+static BigInt operator%(BigInt self, T other) {
   self %= other;
   return self;
 }
 
+template <NativeInt T>
+static BigInt operator+(T other, BigInt self) {
+  self += other;
+  return self;
+}
+
+template <NativeInt T>
+static BigInt operator-(T other, BigInt self) {
+  self -= other;
+  return -std::move(self);
+}
+
+template <NativeInt T>
+static BigInt operator*(T other, BigInt self) {
+  self *= other;
+  return self;
+}
+
+// |other| < |self| almost always, so these are cheap anyway
+template <NativeInt T>
+static BigInt operator/(T other, const BigInt& self) {
+  return BigInt(other) / self;
+}
+
+template <NativeInt T>
+static BigInt operator%(T other, const BigInt& self) {
+  return BigInt(other) % self;
+}
+
+// Parses incrementally from the stream buffer without building a string.
+// Malformed token (no digits or trailing non-space chars) sets failbit and
+// leaves val zero. operator>> picks radix from std::hex/std::oct flags.
+std::istream& ReadBigInt(std::istream& stream, BigInt& val, int radix);
 std::istream& operator>>(std::istream& stream, BigInt& val);
\ No newline at end of file
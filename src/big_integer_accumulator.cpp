@@ -0,0 +1,165 @@
+#include "big_integer_accumulator.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include "big_integer_tuning.hpp"
+
+namespace {
+constexpr int kLimbBits = sizeof(uint32_t) * CHAR_BIT;
+
+// With lanes <= (2^32 - 1)^2 adding a carry below 2^32 can't overflow
+constexpr uint64_t kMaxUnits = UINT32_MAX;
+
+void NormalizeLanes(std::vector<uint64_t>& lanes) {
+  uint64_t carry = 0;
+
+  for (auto& lane : lanes) {
+    lane += carry;
+    carry = lane >> kLimbBits;
+    lane &= UINT32_MAX;
+  }
+
+  for (; carry > 0; carry >>= kLimbBits) {
+    lanes.push_back(carry & UINT32_MAX);
+  }
+}
+
+void GrowLanes(std::vector<uint64_t>& lanes, std::size_t size) {
+  if (lanes.size() < size) {
+    lanes.resize(size, 0);
+  }
+}
+
+};  // namespace
+
+BigIntAccumulator& BigIntAccumulator::operator+=(const BigInt& val) {
+  return AddLimbs(val.sign_ == BigInt::Sign::Negative, val.digits_);
+}
+
+BigIntAccumulator& BigIntAccumulator::operator-=(const BigInt& val) {
+  return AddLimbs(val.sign_ == BigInt::Sign::Positive, val.digits_);
+}
+
+BigIntAccumulator& BigIntAccumulator::AddLimbs(bool negative,
+                                               const Limbs& limbs) {
+  if (limbs.empty()) {
+    return *this;
+  }
+
+  Spend(1);
+  Lanes& lanes = negative ? negative_ : positive_;
+  GrowLanes(lanes, limbs.size());
+
+  for (std::size_t i = 0; i < limbs.size(); ++i) {
+    lanes[i] += limbs[i];
+  }
+
+  return *this;
+}
+
+BigIntAccumulator& BigIntAccumulator::AddNative(bool negative, uint64_t abs) {
+  if (abs == 0) {
+    return *this;
+  }
+
+  Spend(1);
+  Lanes& lanes = negative ? negative_ : positive_;
+  GrowLanes(lanes, 2);
+
+  lanes[0] += abs & UINT32_MAX;
+  lanes[1] += abs >> kLimbBits;
+  return *this;
+}
+
+// Each lane k gets at most min(n, m) low halves and min(n, m) high halves
+BigIntAccumulator& BigIntAccumulator::AddProduct(const BigInt& lhs,
+                                                 const BigInt& rhs) {
+  const Limbs& lhs_limbs = lhs.digits_;
+  const Limbs& rhs_limbs = rhs.digits_;
+  std::size_t min_size = std::min(lhs_limbs.size(), rhs_limbs.size());
+
+  if (min_size == 0) {
+    return *this;
+  }
+
+  if (min_size >= GetThresholds().karatsuba_mul) {
+    return *this += lhs * rhs;  // fast multiplication wins here
+  }
+
+  Spend(2 * min_size);
+  bool negative = (lhs.sign_ != rhs.sign_);
+  Lanes& lanes = negative ? negative_ : positive_;
+  GrowLanes(lanes, lhs_limbs.size() + rhs_limbs.size());
+
+  for (std::size_t i = 0; i < lhs_limbs.size(); ++i) {
+    for (std::size_t j = 0; j < rhs_limbs.size(); ++j) {
+      uint64_t prod = static_cast<uint64_t>(lhs_limbs[i]) * rhs_limbs[j];
+      lanes[i + j] += prod & UINT32_MAX;
+      lanes[i + j + 1] += prod >> kLimbBits;
+    }
+  }
+
+  return *this;
+}
+
+void BigIntAccumulator::Merge(BigIntAccumulator other) {
+  if (used_ + other.used_ > kMaxUnits) {
+    Normalize();
+    other.Normalize();
+  }
+
+  GrowLanes(positive_, other.positive_.size());
+  GrowLanes(negative_, other.negative_.size());
+
+  for (std::size_t i = 0; i < other.positive_.size(); ++i) {
+    positive_[i] += other.positive_[i];
+  }
+  for (std::size_t i = 0; i < other.negative_.size(); ++i) {
+    negative_[i] += other.negative_[i];
+  }
+
+  used_ += other.used_;
+}
+
+BigInt BigIntAccumulator::Result() {
+  Normalize();
+  return FromLanes(positive_) - FromLanes(negative_);
+}
+
+void BigIntAccumulator::Clear() {
+  positive_.clear();
+  negative_.clear();
+  used_ = 0;
+}
+
+BigInt BigIntAccumulator::FromLanes(const Lanes& lanes) {
+  std::size_t size = lanes.size();
+  while (size > 0 && lanes[size - 1] == 0) {
+    --size;
+  }
+
+  if (size == 0) {
+    return BigInt();
+  }
+
+  return BigInt(BigInt::Sign::Positive,
+                Limbs(lanes.begin(), lanes.begin() + size));
+}
+
+void BigIntAccumulator::Spend(uint64_t units) {
+  assert(units < kMaxUnits);
+
+  if (used_ + units > kMaxUnits) {
+    Normalize();
+  }
+
+  used_ += units;
+}
+
+void BigIntAccumulator::Normalize() {
+  NormalizeLanes(positive_);
+  NormalizeLanes(negative_);
+  used_ = std::min<uint64_t>(used_, 1);
+}
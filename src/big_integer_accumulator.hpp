@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "big_integer.hpp"
+
+// Sums huge streams of BigInts in a carry-save form: every 32-bit limb
+// position gets a 64-bit lane, addends are added lane-wise without carry
+// propagation, positive and negative addends go to separate lanes. Carries
+// are only normalized when headroom runs out or on Result().
+//
+// For parallel reductions give each thread its own accumulator and Merge.
+class BigIntAccumulator {
+ public:
+  BigIntAccumulator& operator+=(const BigInt& val);
+  BigIntAccumulator& operator-=(const BigInt& val);
+
+  template <NativeInt T>
+  BigIntAccumulator& operator+=(T val) {
+    return AddNative(val < 0, BigInt::NativeAbs(val));
+  }
+
+  template <NativeInt T>
+  BigIntAccumulator& operator-=(T val) {
+    return AddNative(val > 0, BigInt::NativeAbs(val));
+  }
+
+  // += lhs * rhs, small products go straight into the lanes
+  BigIntAccumulator& AddProduct(const BigInt& lhs, const BigInt& rhs);
+
+  void Merge(BigIntAccumulator other);
+
+  // Normalizes the lanes (the value is kept, accumulation can go on)
+  BigInt Result();
+
+  void Clear();
+
+ private:
+  using Lanes = std::vector<uint64_t>;
+
+  BigIntAccumulator& AddLimbs(bool negative, const Limbs& limbs);
+  BigIntAccumulator& AddNative(bool negative, uint64_t abs);
+
+  // Reserves headroom for `units` more addends below 2^32 in any lane
+  void Spend(uint64_t units);
+  void Normalize();
+
+  // Lanes must be normalized
+  static BigInt FromLanes(const Lanes& lanes);
+
+  Lanes positive_;
+  Lanes negative_;
+
+  // Every lane is at most used_ * (2^32 - 1)
+  uint64_t used_ = 0;
+};
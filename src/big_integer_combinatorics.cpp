@@ -0,0 +1,201 @@
+#include "big_integer_combinatorics.hpp"
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+// Smaller subtrees are not worth a thread
+constexpr std::size_t kMinParallelSize = 256;
+
+// Below this n the factorial is a plain range product
+constexpr uint64_t kMinSwingFactorial = 32;
+
+// Binomials of larger n divide range products instead of sieving up to n
+constexpr uint64_t kMaxBinomialSieve = uint64_t{1} << 26;
+
+int ParallelDepth() {
+  static const int kDepth = [] {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    int depth = 0;
+    while ((2u << depth) <= threads) {
+      ++depth;
+    }
+    return depth;
+  }();
+  return kDepth;
+}
+
+template <typename T>
+BigInt ProductTree(std::span<const T> values, int depth) {
+  if (values.empty()) {
+    return BigInt(1);
+  }
+  if (values.size() == 1) {
+    return BigInt(values[0]);
+  }
+
+  std::size_t mid = values.size() / 2;
+  BigInt lhs;
+  BigInt rhs;
+
+  if (depth > 0 && values.size() >= kMinParallelSize) {
+    auto future = std::async(std::launch::async, ProductTree<T>,
+                             values.first(mid), depth - 1);
+    rhs = ProductTree(values.subspan(mid), depth - 1);
+    lhs = future.get();
+  } else {
+    lhs = ProductTree(values.first(mid), 0);
+    rhs = ProductTree(values.subspan(mid), 0);
+  }
+
+  Mul(lhs, lhs, rhs);
+  return lhs;
+}
+
+// Packs factors into as few machine words as possible
+class FactorList {
+ public:
+  void Push(uint64_t factor) {
+    UInt128 prod = static_cast<UInt128>(word_) * factor;
+    if (prod > UINT64_MAX) {
+      words_.push_back(word_);
+      word_ = factor;
+    } else {
+      word_ = static_cast<uint64_t>(prod);
+    }
+  }
+
+  BigInt Product() {
+    if (word_ != 1) {
+      words_.push_back(word_);
+      word_ = 1;
+    }
+    return ProductTree(std::span<const uint64_t>(words_), ParallelDepth());
+  }
+
+ private:
+  std::vector<uint64_t> words_;
+  uint64_t word_ = 1;
+};
+
+// Sieve of Eratosthenes over odd numbers, is_composite[i] is for 2 * i + 1
+std::vector<uint64_t> PrimesUpTo(uint64_t n) {
+  std::vector<uint64_t> primes;
+  if (n < 2) {
+    return primes;
+  }
+
+  primes.push_back(2);
+  std::vector<bool> is_composite(n / 2 + 1, false);
+
+  for (uint64_t i = 1; 2 * i + 1 <= n; ++i) {
+    if (is_composite[i]) {
+      continue;
+    }
+
+    uint64_t p = 2 * i + 1;
+    primes.push_back(p);
+    if (p > n / p) {
+      continue;
+    }
+    for (uint64_t j = p * p / 2; j < is_composite.size(); j += p) {
+      is_composite[j] = true;
+    }
+  }
+
+  return primes;
+}
+
+// swing(n) = n! / ((n / 2)!)^2, p divides it once per odd n / p^i
+BigInt Swing(uint64_t n, const std::vector<uint64_t>& primes) {
+  FactorList factors;
+
+  for (uint64_t p : primes) {
+    if (p > n) {
+      break;
+    }
+
+    for (uint64_t q = n / p; q > 0; q /= p) {
+      if (q & 1) {
+        factors.Push(p);
+      }
+    }
+  }
+
+  return factors.Product();
+}
+
+BigInt SwingFactorial(uint64_t n, const std::vector<uint64_t>& primes) {
+  if (n < kMinSwingFactorial) {
+    return ProductRange(2, n);
+  }
+
+  BigInt res = SwingFactorial(n / 2, primes);
+  Mul(res, res, res);
+  Mul(res, res, Swing(n, primes));
+  return res;
+}
+};  // namespace
+
+BigInt Product(std::span<const BigInt> values) {
+  return ProductTree(values, ParallelDepth());
+}
+
+BigInt ProductRange(uint64_t first, uint64_t last) {
+  FactorList factors;
+
+  for (uint64_t i = first; i <= last; ++i) {
+    factors.Push(i);
+    if (i == UINT64_MAX) {
+      break;
+    }
+  }
+
+  return factors.Product();
+}
+
+BigInt Factorial(uint64_t n) {
+  if (n < kMinSwingFactorial) {
+    return ProductRange(2, n);
+  }
+  return SwingFactorial(n, PrimesUpTo(n));
+}
+
+// Kummer: the exponent of p is the number of borrows when subtracting
+// k from n in base p
+BigInt Binomial(uint64_t n, uint64_t k) {
+  if (k > n) {
+    return BigInt();
+  }
+
+  k = std::min(k, n - k);
+  if (n > kMaxBinomialSieve) {
+    return ProductRange(n - k + 1, n) / Factorial(k);
+  }
+
+  FactorList factors;
+
+  for (uint64_t p : PrimesUpTo(n)) {
+    uint64_t borrow = 0;
+    for (uint64_t a = n, b = k; a > 0; a /= p, b /= p) {
+      borrow = (a % p < b % p + borrow) ? 1 : 0;
+      if (borrow) {
+        factors.Push(p);
+      }
+    }
+  }
+
+  return factors.Product();
+}
+
+BigInt Primorial(uint64_t n) {
+  FactorList factors;
+
+  for (uint64_t p : PrimesUpTo(n)) {
+    factors.Push(p);
+  }
+
+  return factors.Product();
+}
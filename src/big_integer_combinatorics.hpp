@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "big_integer.hpp"
+
+// Products are evaluated by a balanced product tree, so both operands of
+// every multiplication have similar sizes and the fast multiplication tiers
+// kick in. Large subtrees are computed on separate threads.
+
+// Product of all values, 1 for an empty span
+BigInt Product(std::span<const BigInt> values);
+
+// first * (first + 1) * ... * last, 1 when first > last
+BigInt ProductRange(uint64_t first, uint64_t last);
+
+// n! via Luschny's prime swing: n! = ((n / 2)!)^2 * swing(n)
+BigInt Factorial(uint64_t n);
+
+// n choose k from its prime factorization, 0 when k > n
+BigInt Binomial(uint64_t n, uint64_t k);
+
+// Product of all primes <= n
+BigInt Primorial(uint64_t n);
@@ -0,0 +1,502 @@
+#include "big_integer_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+constexpr char kFileMagic[8] = {'B', 'I', 'G', 'I', 'N', 'T', 'F', '1'};
+constexpr char kCheckpointMagic[8] = {'B', 'I', 'G', 'I', 'N', 'T', 'C', '1'};
+constexpr std::size_t kHeaderBytes = 64;
+
+// Blocks are never cut finer than this, whatever the budget
+constexpr std::size_t kMinBlockLimbs = 64;
+
+// Heap buffers of Mul in blocks: two operand blocks, their product, the
+// running sum of the output block and the carry
+constexpr std::size_t kMulBlockBuffers = 7;
+
+struct CheckpointHeader {
+  char magic[8];
+  uint64_t fingerprint;
+  uint64_t block;
+  uint64_t next_window;
+  uint64_t carry_limbs;
+};
+
+int SignValue(BigInt::Sign sign) {
+  switch (sign) {
+    case BigInt::Sign::Negative:
+      return -1;
+    case BigInt::Sign::Zero:
+      return 0;
+    case BigInt::Sign::Positive:
+      return 1;
+  }
+  return 0;
+}
+
+BigInt::Sign SignFromValue(int value) {
+  if (value == 0) {
+    return BigInt::Sign::Zero;
+  }
+  return (value > 0) ? BigInt::Sign::Positive : BigInt::Sign::Negative;
+}
+
+bool WriteAll(int fd, const void* data, std::size_t bytes) {
+  const auto* ptr = static_cast<const char*>(data);
+  while (bytes > 0) {
+    ssize_t done = write(fd, ptr, bytes);
+    if (done <= 0) {
+      return false;
+    }
+    ptr += done;
+    bytes -= static_cast<std::size_t>(done);
+  }
+  return true;
+}
+
+bool ReadAll(int fd, void* data, std::size_t bytes) {
+  auto* ptr = static_cast<char*>(data);
+  while (bytes > 0) {
+    ssize_t done = read(fd, ptr, bytes);
+    if (done <= 0) {
+      return false;
+    }
+    ptr += done;
+    bytes -= static_cast<std::size_t>(done);
+  }
+  return true;
+}
+
+std::strong_ordering CompareMagnitude(std::span<const uint32_t> lhs,
+                                      std::span<const uint32_t> rhs) {
+  if (lhs.size() != rhs.size()) {
+    return lhs.size() <=> rhs.size();
+  }
+
+  for (std::size_t i = lhs.size(); i-- > 0;) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] <=> rhs[i];
+    }
+  }
+  return std::strong_ordering::equal;
+}
+
+// Ties a checkpoint to its operands
+uint64_t Fingerprint(const BigIntFile& lhs, const BigIntFile& rhs) {
+  constexpr uint64_t kPrime = 0x100000001b3;
+  uint64_t hash = 0xcbf29ce484222325;
+
+  for (const BigIntFile* val : {&lhs, &rhs}) {
+    hash = (hash ^ val->LimbCount()) * kPrime;
+    hash = (hash ^ static_cast<uint64_t>(SignValue(val->Sign()))) * kPrime;
+    for (uint32_t limb : val->Limbs()) {
+      hash = (hash ^ limb) * kPrime;
+    }
+  }
+  return hash;
+}
+
+// Written aside and renamed over, so a crash leaves the old or the new one
+bool WriteCheckpoint(const std::string& path, const CheckpointHeader& header,
+                     std::span<const uint32_t> carry) {
+  std::string tmp_path = path + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool ok = WriteAll(fd, &header, sizeof(header)) &&
+            WriteAll(fd, carry.data(), carry.size_bytes()) && fsync(fd) == 0;
+  ok = (close(fd) == 0) && ok;
+  return ok && std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool ReadCheckpoint(const std::string& path, CheckpointHeader& header,
+                    std::vector<uint32_t>& carry) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  bool ok = ReadAll(fd, &header, sizeof(header)) &&
+            std::memcmp(header.magic, kCheckpointMagic,
+                        sizeof(kCheckpointMagic)) == 0;
+  if (ok) {
+    carry.resize(header.carry_limbs);
+    ok = ReadAll(fd, carry.data(), carry.size() * sizeof(uint32_t));
+  }
+  close(fd);
+  return ok;
+}
+
+// Low limbs of src, zero padded to the length of dst
+void StoreWindow(std::span<uint32_t> dst, std::span<const uint32_t> src) {
+  std::size_t count = std::min(dst.size(), src.size());
+  std::copy_n(src.begin(), count, dst.begin());
+  std::fill(dst.begin() + static_cast<std::ptrdiff_t>(count), dst.end(), 0);
+}
+};  // namespace
+
+struct BigIntFile::Header {
+  char magic[8];
+  int32_t sign;
+  uint32_t reserved;
+  uint64_t limbs;
+  char padding[kHeaderBytes - 24];
+};
+
+BigIntFile::BigIntFile(int fd, void* map, std::size_t capacity)
+    : fd_(fd), map_(map), capacity_(capacity) {}
+
+BigIntFile::BigIntFile(BigIntFile&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1)),
+      map_(std::exchange(other.map_, nullptr)),
+      capacity_(std::exchange(other.capacity_, 0)) {}
+
+BigIntFile& BigIntFile::operator=(BigIntFile&& other) noexcept {
+  std::swap(fd_, other.fd_);
+  std::swap(map_, other.map_);
+  std::swap(capacity_, other.capacity_);
+  return *this;
+}
+
+BigIntFile::~BigIntFile() {
+  if (map_ != nullptr) {
+    munmap(map_, kHeaderBytes + capacity_ * sizeof(uint32_t));
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+std::optional<BigIntFile> BigIntFile::Create(const std::string& path,
+                                             std::size_t capacity) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  // Blocks are reserved up front: a sparse file would turn a full disk
+  // into SIGBUS on a later store through the mapping
+  std::size_t bytes = kHeaderBytes + capacity * sizeof(uint32_t);
+  if (posix_fallocate(fd, 0, static_cast<off_t>(bytes)) != 0) {
+    close(fd);
+    unlink(path.c_str());
+    return std::nullopt;
+  }
+
+  void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  BigIntFile res(fd, map, capacity);
+  std::memcpy(res.GetHeader().magic, kFileMagic, sizeof(kFileMagic));
+  return res;
+}
+
+std::optional<BigIntFile> BigIntFile::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  struct stat info {};
+  if (fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < kHeaderBytes) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  auto bytes = static_cast<std::size_t>(info.st_size);
+  void* map = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  BigIntFile res(fd, map, (bytes - kHeaderBytes) / sizeof(uint32_t));
+  const Header& header = res.GetHeader();
+  if (std::memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 ||
+      header.limbs > res.capacity_ ||
+      (header.limbs == 0) != (header.sign == 0)) {
+    return std::nullopt;
+  }
+  return res;
+}
+
+std::optional<BigIntFile> BigIntFile::Save(const std::string& path,
+                                           const BigInt& val) {
+  std::span<const uint32_t> limbs = LimbsOf(val);
+  auto res = Create(path, limbs.size());
+  if (!res) {
+    return std::nullopt;
+  }
+
+  std::copy(limbs.begin(), limbs.end(), res->Data());
+  res->Finish(val.sign_);
+  return res;
+}
+
+BigInt BigIntFile::Load() const {
+  BigInt res = FromLimbs(Limbs());
+  if (Sign() == BigInt::Sign::Negative) {
+    res = -std::move(res);
+  }
+  return res;
+}
+
+BigInt::Sign BigIntFile::Sign() const {
+  return SignFromValue(GetHeader().sign);
+}
+
+std::size_t BigIntFile::LimbCount() const {
+  return GetHeader().limbs;
+}
+
+std::span<const uint32_t> BigIntFile::Limbs() const {
+  return {Data(), LimbCount()};
+}
+
+bool BigIntFile::Sync() const {
+  return msync(map_, kHeaderBytes + capacity_ * sizeof(uint32_t), MS_SYNC) ==
+         0;
+}
+
+bool BigIntFile::SyncLimbs(std::size_t offset, std::size_t count) const {
+  // msync wants a page-aligned start
+  auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::size_t begin = kHeaderBytes + offset * sizeof(uint32_t);
+  std::size_t end = begin + count * sizeof(uint32_t);
+  begin -= begin % page;
+  return msync(static_cast<char*>(map_) + begin, end - begin, MS_SYNC) == 0;
+}
+
+bool BigIntFile::IsStoredAt(const std::string& path) const {
+  struct stat path_info {};
+  struct stat own_info {};
+  return stat(path.c_str(), &path_info) == 0 && fstat(fd_, &own_info) == 0 &&
+         path_info.st_dev == own_info.st_dev &&
+         path_info.st_ino == own_info.st_ino;
+}
+
+BigIntFile::Header& BigIntFile::GetHeader() const {
+  static_assert(sizeof(Header) == kHeaderBytes);
+  return *static_cast<Header*>(map_);
+}
+
+uint32_t* BigIntFile::Data() const {
+  return reinterpret_cast<uint32_t*>(static_cast<char*>(map_) + kHeaderBytes);
+}
+
+void BigIntFile::Finish(BigInt::Sign sign) {
+  std::size_t limbs = capacity_;
+  while (limbs > 0 && Data()[limbs - 1] == 0) {
+    --limbs;
+  }
+
+  GetHeader().limbs = limbs;
+  GetHeader().sign = (limbs == 0) ? 0 : SignValue(sign);
+}
+
+BigInt BigIntFile::FromLimbs(std::span<const uint32_t> limbs) {
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs = limbs.first(limbs.size() - 1);
+  }
+  if (limbs.empty()) {
+    return BigInt();
+  }
+
+  return BigInt(BigInt::Sign::Positive,
+                ::Limbs(limbs.begin(), limbs.end()));
+}
+
+std::span<const uint32_t> BigIntFile::LimbsOf(const BigInt& val) {
+  return val.digits_;
+}
+
+std::strong_ordering Compare(const BigIntFile& lhs, const BigIntFile& rhs) {
+  int lhs_sign = SignValue(lhs.Sign());
+  int rhs_sign = SignValue(rhs.Sign());
+  if (lhs_sign != rhs_sign || lhs_sign == 0) {
+    return lhs_sign <=> rhs_sign;
+  }
+
+  auto res = CompareMagnitude(lhs.Limbs(), rhs.Limbs());
+  return (lhs_sign > 0) ? res : 0 <=> res;
+}
+
+// Magnitudes are added or the smaller is subtracted from the larger, in
+// one pass from the low limbs
+std::optional<BigIntFile> BigIntFile::AddSigned(const std::string& path,
+                                                const BigIntFile& lhs,
+                                                const BigIntFile& rhs,
+                                                bool negate) {
+  if (lhs.IsStoredAt(path) || rhs.IsStoredAt(path)) {
+    return std::nullopt;
+  }
+
+  int lhs_sign = SignValue(lhs.Sign());
+  int rhs_sign = negate ? -SignValue(rhs.Sign()) : SignValue(rhs.Sign());
+  std::span<const uint32_t> big = lhs.Limbs();
+  std::span<const uint32_t> small = rhs.Limbs();
+  int sign = lhs_sign;
+
+  bool subtract = (lhs_sign * rhs_sign < 0);
+  if (subtract ? CompareMagnitude(big, small) < 0 : big.size() < small.size()) {
+    std::swap(big, small);
+    sign = rhs_sign;
+  }
+  if (sign == 0) {
+    sign = rhs_sign;
+  }
+
+  auto res = Create(path, big.size() + 1);
+  if (!res) {
+    return std::nullopt;
+  }
+
+  uint32_t* out = res->Data();
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < big.size(); ++i) {
+    uint64_t other = (i < small.size()) ? small[i] : 0;
+    if (subtract) {
+      uint64_t cur = uint64_t{big[i]} - other - carry;
+      out[i] = static_cast<uint32_t>(cur);
+      carry = cur >> 63;
+    } else {
+      uint64_t cur = uint64_t{big[i]} + other + carry;
+      out[i] = static_cast<uint32_t>(cur);
+      carry = cur >> 32;
+    }
+  }
+  out[big.size()] = static_cast<uint32_t>(carry);
+
+  res->Finish(SignFromValue(sign));
+  return res;
+}
+
+std::optional<BigIntFile> Add(const std::string& path, const BigIntFile& lhs,
+                              const BigIntFile& rhs) {
+  return BigIntFile::AddSigned(path, lhs, rhs, false);
+}
+
+std::optional<BigIntFile> Sub(const std::string& path, const BigIntFile& lhs,
+                              const BigIntFile& rhs) {
+  return BigIntFile::AddSigned(path, lhs, rhs, true);
+}
+
+// Output block k is the carry of block k - 1 plus all block products
+// lhs_i * rhs_j with i + j = k. Each block is written once, so the state
+// between blocks is only k and the carry.
+std::optional<BigIntFile> Mul(
+    const std::string& path, const BigIntFile& lhs, const BigIntFile& rhs,
+    std::size_t memory_budget,
+    const std::function<bool(uint64_t, uint64_t)>& progress) {
+  if (lhs.IsStoredAt(path) || rhs.IsStoredAt(path)) {
+    return std::nullopt;
+  }
+
+  std::string checkpoint_path = path + ".ckpt";
+  std::span<const uint32_t> lhs_limbs = lhs.Limbs();
+  std::span<const uint32_t> rhs_limbs = rhs.Limbs();
+  std::size_t total_limbs = lhs_limbs.size() + rhs_limbs.size();
+  uint64_t fingerprint = Fingerprint(lhs, rhs);
+
+  CheckpointHeader state{};
+  std::vector<uint32_t> carry_limbs;
+
+  std::optional<BigIntFile> res;
+  if (ReadCheckpoint(checkpoint_path, state, carry_limbs) &&
+      state.fingerprint == fingerprint) {
+    res = BigIntFile::Open(path);
+    if (res && res->capacity_ != total_limbs) {
+      res.reset();
+    }
+  }
+  if (!res) {
+    std::memcpy(state.magic, kCheckpointMagic, sizeof(kCheckpointMagic));
+    state.fingerprint = fingerprint;
+    state.block = std::max(
+        kMinBlockLimbs, memory_budget / (kMulBlockBuffers * sizeof(uint32_t)));
+    state.next_window = 0;
+    carry_limbs.clear();
+
+    // A checkpoint left by other operands must not outlive the file it
+    // described, a crash before our first one would resume from it
+    std::remove(checkpoint_path.c_str());
+    res = BigIntFile::Create(path, total_limbs);
+    if (!res || !res->Sync()) {
+      return std::nullopt;
+    }
+  }
+
+  std::size_t block = state.block;
+  std::size_t lhs_blocks = (lhs_limbs.size() + block - 1) / block;
+  std::size_t rhs_blocks = (rhs_limbs.size() + block - 1) / block;
+  std::size_t windows =
+      (lhs_blocks == 0 || rhs_blocks == 0) ? 0 : lhs_blocks + rhs_blocks - 1;
+
+  auto block_of = [block](std::span<const uint32_t> limbs, std::size_t idx) {
+    std::size_t offset = idx * block;
+    return BigIntFile::FromLimbs(
+        limbs.subspan(offset, std::min(block, limbs.size() - offset)));
+  };
+  auto window_of = [&](std::size_t idx) {
+    std::size_t offset = std::min(idx * block, total_limbs);
+    return std::span<uint32_t>(res->Data() + offset,
+                               std::min(block, total_limbs - offset));
+  };
+
+  BigInt carry = BigIntFile::FromLimbs(carry_limbs);
+  BigInt prod;
+  for (std::size_t k = state.next_window; k < windows; ++k) {
+    BigInt sum = std::move(carry);
+    std::size_t first = (k >= rhs_blocks) ? k - rhs_blocks + 1 : 0;
+    std::size_t last = std::min(k, lhs_blocks - 1);
+    for (std::size_t i = first; i <= last; ++i) {
+      ::Mul(prod, block_of(lhs_limbs, i), block_of(rhs_limbs, k - i));
+      sum += prod;
+    }
+
+    StoreWindow(window_of(k), BigIntFile::LimbsOf(sum));
+    carry = std::move(sum);
+    carry >>= block * 32;
+
+    // Limbs first, then the checkpoint that points past them
+    state.next_window = k + 1;
+    std::span<const uint32_t> carry_span = BigIntFile::LimbsOf(carry);
+    state.carry_limbs = carry_span.size();
+    std::span<uint32_t> window = window_of(k);
+    auto offset = static_cast<std::size_t>(window.data() - res->Data());
+    if (!res->SyncLimbs(offset, window.size()) ||
+        !WriteCheckpoint(checkpoint_path, state, carry_span)) {
+      return std::nullopt;
+    }
+
+    if (progress && !progress(k + 1, windows)) {
+      return std::nullopt;
+    }
+  }
+
+  // The last carry fills what is left above the last block
+  StoreWindow(window_of(windows), BigIntFile::LimbsOf(carry));
+  res->Finish(lhs.Sign() * rhs.Sign());
+  if (!res->Sync()) {
+    return std::nullopt;
+  }
+
+  std::remove(checkpoint_path.c_str());
+  return res;
+}
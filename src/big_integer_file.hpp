@@ -0,0 +1,108 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "big_integer.hpp"
+
+// BigInt whose limbs live in a memory-mapped file (POSIX mmap), for values
+// too large for RAM. The file holds a small header with the sign and the
+// limb count, then the magnitude little-endian. The page cache holds what
+// is touched, so heap usage is bounded by the block buffers of the
+// operations below rather than by the operand size.
+//
+// I/O failures are reported as std::nullopt / false.
+class BigIntFile {
+ public:
+  BigIntFile(const BigIntFile&) = delete;
+  BigIntFile& operator=(const BigIntFile&) = delete;
+  BigIntFile(BigIntFile&& other) noexcept;
+  BigIntFile& operator=(BigIntFile&& other) noexcept;
+  ~BigIntFile();
+
+  // Zero with room for capacity limbs, an existing file is overwritten
+  static std::optional<BigIntFile> Create(const std::string& path,
+                                          std::size_t capacity);
+  static std::optional<BigIntFile> Open(const std::string& path);
+  static std::optional<BigIntFile> Save(const std::string& path,
+                                        const BigInt& val);
+
+  // Copies into memory, only for values that fit there
+  BigInt Load() const;
+
+  BigInt::Sign Sign() const;
+  std::size_t LimbCount() const;
+  std::span<const uint32_t> Limbs() const;
+
+  // Flushes dirty pages and the header to the file
+  bool Sync() const;
+
+ private:
+  struct Header;
+
+  BigIntFile(int fd, void* map, std::size_t capacity);
+
+  bool SyncLimbs(std::size_t offset, std::size_t count) const;
+
+  // Whether path names this file, under any link or spelling
+  bool IsStoredAt(const std::string& path) const;
+  Header& GetHeader() const;
+  uint32_t* Data() const;
+
+  // Sets sign and limb count after the limbs were written, drops zero limbs
+  // from the top
+  void Finish(BigInt::Sign sign);
+
+  // Blocks in and out of BigInts, without the string round trip
+  static BigInt FromLimbs(std::span<const uint32_t> limbs);
+  static std::span<const uint32_t> LimbsOf(const BigInt& val);
+
+  static std::optional<BigIntFile> AddSigned(const std::string& path,
+                                             const BigIntFile& lhs,
+                                             const BigIntFile& rhs,
+                                             bool negate);
+
+  int fd_ = -1;
+  void* map_ = nullptr;
+  std::size_t capacity_ = 0;
+
+  friend std::optional<BigIntFile> Add(const std::string& path,
+                                       const BigIntFile& lhs,
+                                       const BigIntFile& rhs);
+  friend std::optional<BigIntFile> Sub(const std::string& path,
+                                       const BigIntFile& lhs,
+                                       const BigIntFile& rhs);
+  friend std::optional<BigIntFile> Mul(
+      const std::string& path, const BigIntFile& lhs, const BigIntFile& rhs,
+      std::size_t memory_budget,
+      const std::function<bool(uint64_t, uint64_t)>& progress);
+};
+
+std::strong_ordering Compare(const BigIntFile& lhs, const BigIntFile& rhs);
+
+// Single sequential pass over both operands into a new file at path.
+// Here and in Mul the output path must not name an operand's file, that
+// gives std::nullopt instead of overwriting the operand.
+std::optional<BigIntFile> Add(const std::string& path, const BigIntFile& lhs,
+                              const BigIntFile& rhs);
+std::optional<BigIntFile> Sub(const std::string& path, const BigIntFile& lhs,
+                              const BigIntFile& rhs);
+
+// Blocked schoolbook over in-memory block products: operands are cut into
+// blocks sized from memory_budget (bytes), and the output is produced one
+// block at a time as the sum of its block products plus the carry, each
+// product going through the in-memory Karatsuba.
+//
+// After every output block the carry and position go to path + ".ckpt", a
+// Mul with the same operands and path resumes from there. progress gets
+// (done, total) output blocks, returning false stops with std::nullopt and
+// leaves the checkpoint for a later resume.
+std::optional<BigIntFile> Mul(
+    const std::string& path, const BigIntFile& lhs, const BigIntFile& rhs,
+    std::size_t memory_budget,
+    const std::function<bool(uint64_t, uint64_t)>& progress = {});
@@ -0,0 +1,111 @@
+#include "big_integer_parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+// One ParallelFor call. Tasks are claimed through next, so the job can sit
+// in the queue until a worker finds it exhausted.
+struct Job {
+  const std::function<void(std::size_t)>* fn;
+  std::size_t count;
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> done{0};
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+// Runs tasks of job until none are left unclaimed
+void Drain(Job& job) {
+  for (std::size_t i = job.next++; i < job.count; i = job.next++) {
+    (*job.fn)(i);
+
+    if (++job.done == job.count) {
+      std::lock_guard<std::mutex> lock(job.mutex);
+      job.finished.notify_all();
+    }
+  }
+}
+
+class WorkerPool {
+ public:
+  explicit WorkerPool(unsigned workers) {
+    for (unsigned i = 0; i < workers; ++i) {
+      threads_.emplace_back([this] { Work(); });
+    }
+  }
+
+  // Never destroyed, workers may be busy while static destructors run
+  static WorkerPool& Instance() {
+    static WorkerPool& pool = *new WorkerPool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+  }
+
+  unsigned Workers() const { return static_cast<unsigned>(threads_.size()); }
+
+  void Run(std::size_t count, const std::function<void(std::size_t)>& fn) {
+    auto job = std::make_shared<Job>();
+    job->fn = &fn;
+    job->count = count;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      jobs_.push_back(job);
+    }
+    wake_.notify_all();
+
+    Drain(*job);
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&] { return job->done == job->count; });
+  }
+
+ private:
+  void Work() {
+    while (true) {
+      std::shared_ptr<Job> job;
+
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this] { return !jobs_.empty(); });
+
+        job = jobs_.front();
+        if (job->next >= job->count) {
+          jobs_.pop_front();
+          continue;
+        }
+      }
+
+      Drain(*job);
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  std::vector<std::thread> threads_;
+};
+};  // namespace
+
+void ParallelFor(std::size_t count,
+                 const std::function<void(std::size_t)>& fn) {
+  if (count <= 1 || ParallelThreads() == 1) {
+    for (std::size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  WorkerPool::Instance().Run(count, fn);
+}
+
+unsigned ParallelThreads() {
+  return WorkerPool::Instance().Workers() + 1;
+}
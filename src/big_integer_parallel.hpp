@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Process-wide pool of hardware_concurrency() - 1 worker threads, started on
+// first use and kept until exit, so parallel loops over short operations
+// don't pay for starting threads on every call.
+
+// Calls fn(0) .. fn(count - 1) on the workers and the calling thread and
+// returns once all calls are done. The caller keeps taking tasks itself, so
+// nested calls and calls from many threads at once can't deadlock, they
+// only get fewer helpers.
+void ParallelFor(std::size_t count, const std::function<void(std::size_t)>& fn);
+
+// Threads a ParallelFor can run on, the caller included
+unsigned ParallelThreads();
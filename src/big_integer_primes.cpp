@@ -0,0 +1,592 @@
+#include "big_integer_primes.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <random>
+#include <span>
+
+#include "big_integer_parallel.hpp"
+#include "big_integer_random.hpp"
+
+namespace {
+constexpr int kLimbBits = sizeof(uint32_t) * CHAR_BIT;
+
+// Trial division and sieving use the odd primes below this
+constexpr uint32_t kSmallPrimeLimit = 1024;
+
+// Odd candidates per sieve window
+constexpr std::size_t kSieveWindow = 4096;
+
+// Candidates per parallel batch and thread
+constexpr std::size_t kBatchPerThread = 8;
+
+constexpr int kPowWindowBits = 4;
+
+using Residue = MontgomeryContext::Residue;
+
+struct PrimeGroup {
+  uint32_t product;
+  std::vector<uint32_t> primes;
+};
+
+// Odd small primes grouped so that each product fits in a limb, a single
+// remainder pass over n then serves the whole group
+const std::vector<PrimeGroup>& SmallPrimeGroups() {
+  static const std::vector<PrimeGroup> kGroups = [] {
+    std::vector<bool> is_composite(kSmallPrimeLimit, false);
+    std::vector<PrimeGroup> groups;
+    PrimeGroup cur{1, {}};
+
+    for (uint32_t p = 3; p < kSmallPrimeLimit; p += 2) {
+      if (is_composite[p]) {
+        continue;
+      }
+      for (uint32_t j = p * p; j < kSmallPrimeLimit; j += 2 * p) {
+        is_composite[j] = true;
+      }
+
+      if (static_cast<uint64_t>(cur.product) * p > UINT32_MAX) {
+        groups.push_back(std::move(cur));
+        cur = {1, {}};
+      }
+      cur.product *= p;
+      cur.primes.push_back(p);
+    }
+
+    groups.push_back(std::move(cur));
+    return groups;
+  }();
+
+  return kGroups;
+}
+
+bool GreaterOrEqual(const uint32_t* lhs, const uint32_t* rhs,
+                    std::size_t size) {
+  for (std::size_t i = size; i-- > 0;) {
+    if (lhs[i] != rhs[i]) {
+      return lhs[i] > rhs[i];
+    }
+  }
+  return true;
+}
+
+// Alias-safe, return the outgoing carry/borrow
+uint32_t AddLimbs(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs,
+                  std::size_t size) {
+  uint64_t carry = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t cur = carry + lhs[i] + rhs[i];
+    dst[i] = static_cast<uint32_t>(cur);
+    carry = cur >> kLimbBits;
+  }
+  return static_cast<uint32_t>(carry);
+}
+
+uint32_t SubLimbs(uint32_t* dst, const uint32_t* lhs, const uint32_t* rhs,
+                  std::size_t size) {
+  uint32_t borrow = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t sub = static_cast<uint64_t>(rhs[i]) + borrow;
+    borrow = (lhs[i] < sub) ? 1 : 0;
+    dst[i] = static_cast<uint32_t>(lhs[i] - sub);
+  }
+  return borrow;
+}
+
+// (a / n) for odd n
+int JacobiSmall(uint64_t a, uint64_t n) {
+  int res = 1;
+  a %= n;
+
+  while (a != 0) {
+    while (a % 2 == 0) {
+      a /= 2;
+      if (n % 8 == 3 || n % 8 == 5) {
+        res = -res;
+      }
+    }
+
+    std::swap(a, n);
+    if (a % 4 == 3 && n % 4 == 3) {
+      res = -res;
+    }
+    a %= n;
+  }
+
+  return (n == 1) ? res : 0;
+}
+
+// (d / n) for odd d and odd n > 0, only single-limb remainders of n
+int Jacobi(int64_t d, const BigInt& n) {
+  int res = 1;
+  uint32_t n_mod_4 = n.ModLimb(4);
+  auto abs_d = static_cast<uint32_t>(d < 0 ? -d : d);
+
+  if (d < 0 && n_mod_4 == 3) {
+    res = -res;
+  }
+  if (abs_d % 4 == 3 && n_mod_4 == 3) {
+    res = -res;
+  }
+
+  return res * JacobiSmall(n.ModLimb(abs_d), abs_d);
+}
+
+bool IsSquare(const BigInt& n) {
+  static const uint64_t kSquaresMod64 = [] {
+    uint64_t mask = 0;
+    for (uint64_t i = 0; i < 64; ++i) {
+      mask |= uint64_t{1} << (i * i % 64);
+    }
+    return mask;
+  }();
+
+  if (((kSquaresMod64 >> n.ModLimb(64)) & 1) == 0) {
+    return false;
+  }
+
+  BigInt root = 1;
+  while (root * root <= n) {
+    root.LeftShift(1);
+  }
+
+  // Newton from above converges to floor(sqrt(n))
+  for (;;) {
+    BigInt next = (root + n / root) / 2;
+    if (next >= root) {
+      break;
+    }
+    root = std::move(next);
+  }
+
+  return root * root == n;
+}
+
+// val = odd * 2^s, returns s
+int SplitPowerOfTwo(BigInt& val) {
+  uint64_t shift = val.CountTrailingZeros();
+  val >>= shift;
+  return static_cast<int>(shift);
+}
+
+// n - 1 = d * 2^s
+bool StrongProbablePrime(const MontgomeryContext& ctx, const Residue& base,
+                         const BigInt& d, int s, const Residue& minus_one) {
+  Residue x = ctx.Pow(base, d);
+  if (x == ctx.One() || x == minus_one) {
+    return true;
+  }
+
+  for (int i = 1; i < s; ++i) {
+    ctx.Mul(x, x, x);
+    if (x == minus_one) {
+      return true;
+    }
+    if (x == ctx.One()) {
+      return false;
+    }
+  }
+
+  return false;
+}
+
+// Selfridge's method A: the first D in 5, -7, 9, -11, ... with
+// (D / n) = -1, or 0 when n turns out composite on the way
+int64_t SelfridgeD(const BigInt& n) {
+  for (int64_t d = 5;; d = (d > 0) ? -(d + 2) : -(d - 2)) {
+    int jacobi = Jacobi(d, n);
+    if (jacobi == -1) {
+      return d;
+    }
+    // n > |D| after trial division, so a common factor is a proper one
+    if (jacobi == 0) {
+      return 0;
+    }
+    // Squares never give -1, don't search forever
+    if (d == 13 && IsSquare(n)) {
+      return 0;
+    }
+  }
+}
+
+// Strong Lucas test with P = 1, Q = (1 - D) / 4 on n + 1 = d * 2^s
+bool StrongLucasProbablePrime(const MontgomeryContext& ctx, int64_t disc) {
+  BigInt d = ctx.Modulus() + 1;
+  int s = SplitPowerOfTwo(d);
+
+  Residue disc_res = ctx.ToResidue(BigInt(disc));
+  Residue q = ctx.ToResidue(BigInt((1 - disc) / 4));
+  Residue u = ctx.One();
+  Residue v = ctx.One();
+  Residue qk = q;
+  Residue tmp;
+
+  for (uint64_t bit = d.BitLength() - 1; bit-- > 0;) {
+    // U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+    ctx.Mul(u, u, v);
+    ctx.Mul(v, v, v);
+    ctx.Sub(v, v, qk);
+    ctx.Sub(v, v, qk);
+    ctx.Mul(qk, qk, qk);
+
+    if (d.TestBit(bit)) {
+      // U_k+1 = (U_k + V_k) / 2, V_k+1 = (D U_k + V_k) / 2
+      ctx.Mul(tmp, disc_res, u);
+      ctx.Add(u, u, v);
+      ctx.Half(u);
+      ctx.Add(v, tmp, v);
+      ctx.Half(v);
+      ctx.Mul(qk, qk, q);
+    }
+  }
+
+  Residue zero(ctx.One().size(), 0);
+  if (u == zero || v == zero) {
+    return true;
+  }
+
+  for (int r = 1; r < s; ++r) {
+    ctx.Mul(v, v, v);
+    ctx.Sub(v, v, qk);
+    ctx.Sub(v, v, qk);
+    if (v == zero) {
+      return true;
+    }
+    ctx.Mul(qk, qk, qk);
+  }
+
+  return false;
+}
+
+// Odd candidates start + 2i, window by window. start must be odd and
+// above every small prime. Residues modulo the small primes are advanced
+// incrementally, so a window costs only the marking.
+class CandidateSieve {
+ public:
+  explicit CandidateSieve(BigInt start) : base_(std::move(start)) {
+    for (const auto& group : SmallPrimeGroups()) {
+      uint32_t rem = base_.ModLimb(group.product);
+      for (uint32_t p : group.primes) {
+        primes_.push_back(p);
+        residues_.push_back(rem % p);
+      }
+    }
+  }
+
+  // Candidates of the next window with no small prime factor
+  std::vector<BigInt> NextWindow() {
+    std::vector<bool> is_composite(kSieveWindow, false);
+
+    for (std::size_t k = 0; k < primes_.size(); ++k) {
+      uint64_t p = primes_[k];
+      uint64_t rem = residues_[k];
+
+      // start + 2i = 0 (mod p) <=> i = -rem / 2 (mod p)
+      for (uint64_t i = (p - rem) % p * ((p + 1) / 2) % p; i < kSieveWindow;
+           i += p) {
+        is_composite[i] = true;
+      }
+      residues_[k] = static_cast<uint32_t>((rem + 2 * kSieveWindow) % p);
+    }
+
+    std::vector<BigInt> survivors;
+    for (std::size_t i = 0; i < kSieveWindow; ++i) {
+      if (!is_composite[i]) {
+        survivors.push_back(base_ + 2 * i);
+      }
+    }
+
+    base_ += 2 * kSieveWindow;
+    return survivors;
+  }
+
+ private:
+  BigInt base_;
+  std::vector<uint32_t> primes_;
+  std::vector<uint32_t> residues_;
+};
+
+// Strided over `threads` pool tasks, the pool keeps its workers between
+// batches
+void TestCandidates(std::span<const BigInt> candidates,
+                    std::vector<char>& is_prime, unsigned threads) {
+  ParallelFor(threads, [&](std::size_t first) {
+    for (std::size_t i = first; i < candidates.size(); i += threads) {
+      is_prime[i] = IsProbablePrime(candidates[i]);
+    }
+  });
+}
+};  // namespace
+
+MontgomeryContext::MontgomeryContext(const BigInt& modulus)
+    : modulus_(modulus) {
+  assert(modulus_ > 1 && modulus_.TestBit(0));
+
+  // Odd x is its own inverse mod 8, each Newton step doubles the bits
+  uint32_t low = modulus_.digits_[0];
+  uint32_t inv = low;
+  for (int i = 0; i < 4; ++i) {
+    inv *= 2 - low * inv;
+  }
+  inv_ = 0 - inv;
+
+  std::size_t size = modulus_.digits_.size();
+  BigInt r2 = 1;
+  r2.LeftShift(static_cast<uint32_t>(2 * size));
+  r2 %= modulus_;
+
+  r2_.assign(size, 0);
+  std::copy(r2.digits_.begin(), r2.digits_.end(), r2_.begin());
+  one_ = ToResidue(1);
+}
+
+MontgomeryContext::Residue MontgomeryContext::ToResidue(
+    const BigInt& val) const {
+  BigInt rem = val % modulus_;
+  if (rem < 0) {
+    rem += modulus_;
+  }
+
+  Residue res(modulus_.digits_.size(), 0);
+  std::copy(rem.digits_.begin(), rem.digits_.end(), res.begin());
+  Mul(res, res, r2_);
+  return res;
+}
+
+BigInt MontgomeryContext::FromResidue(const Residue& val) const {
+  Residue unit(val.size(), 0);
+  unit[0] = 1;
+
+  Limbs limbs;
+  Mul(limbs, val, unit);
+
+  while (!limbs.empty() && limbs.back() == 0) {
+    limbs.pop_back();
+  }
+  if (limbs.empty()) {
+    return BigInt();
+  }
+  return BigInt(BigInt::Sign::Positive, std::move(limbs));
+}
+
+// CIOS: interleaves multiplication by a limb of rhs with one reduction
+// step, the scratch never exceeds size + 2 limbs
+void MontgomeryContext::Mul(Residue& dst, const Residue& lhs,
+                            const Residue& rhs) const {
+  const Limbs& mod = modulus_.digits_;
+  std::size_t size = mod.size();
+
+  static thread_local Limbs scratch;
+  scratch.assign(size + 2, 0);
+  uint32_t* t = scratch.data();
+
+  for (std::size_t i = 0; i < size; ++i) {
+    uint64_t carry = 0;
+    for (std::size_t j = 0; j < size; ++j) {
+      uint64_t cur = t[j] + static_cast<uint64_t>(lhs[j]) * rhs[i] + carry;
+      t[j] = static_cast<uint32_t>(cur);
+      carry = cur >> kLimbBits;
+    }
+    uint64_t cur = t[size] + carry;
+    t[size] = static_cast<uint32_t>(cur);
+    t[size + 1] = static_cast<uint32_t>(cur >> kLimbBits);
+
+    uint32_t factor = t[0] * inv_;
+    carry = (t[0] + static_cast<uint64_t>(factor) * mod[0]) >> kLimbBits;
+    for (std::size_t j = 1; j < size; ++j) {
+      cur = t[j] + static_cast<uint64_t>(factor) * mod[j] + carry;
+      t[j - 1] = static_cast<uint32_t>(cur);
+      carry = cur >> kLimbBits;
+    }
+    cur = t[size] + carry;
+    t[size - 1] = static_cast<uint32_t>(cur);
+    t[size] = t[size + 1] + static_cast<uint32_t>(cur >> kLimbBits);
+  }
+
+  // t < 2m here
+  dst.resize(size);
+  if (t[size] != 0 || GreaterOrEqual(t, mod.data(), size)) {
+    SubLimbs(dst.data(), t, mod.data(), size);
+  } else {
+    std::copy(t, t + size, dst.begin());
+  }
+}
+
+void MontgomeryContext::Add(Residue& dst, const Residue& lhs,
+                            const Residue& rhs) const {
+  const Limbs& mod = modulus_.digits_;
+  std::size_t size = mod.size();
+
+  dst.resize(size);
+  uint32_t carry = AddLimbs(dst.data(), lhs.data(), rhs.data(), size);
+  if (carry != 0 || GreaterOrEqual(dst.data(), mod.data(), size)) {
+    SubLimbs(dst.data(), dst.data(), mod.data(), size);
+  }
+}
+
+void MontgomeryContext::Sub(Residue& dst, const Residue& lhs,
+                            const Residue& rhs) const {
+  const Limbs& mod = modulus_.digits_;
+  std::size_t size = mod.size();
+
+  dst.resize(size);
+  if (SubLimbs(dst.data(), lhs.data(), rhs.data(), size) != 0) {
+    AddLimbs(dst.data(), dst.data(), mod.data(), size);
+  }
+}
+
+// Adds m to odd values first, which keeps them congruent
+void MontgomeryContext::Half(Residue& val) const {
+  const Limbs& mod = modulus_.digits_;
+  std::size_t size = mod.size();
+
+  uint32_t carry = 0;
+  if (val[0] & 1) {
+    carry = AddLimbs(val.data(), val.data(), mod.data(), size);
+  }
+
+  for (std::size_t i = 0; i < size; ++i) {
+    uint32_t next = (i + 1 < size) ? val[i + 1] : carry;
+    val[i] = (val[i] >> 1) | (next << (kLimbBits - 1));
+  }
+}
+
+// Fixed 4-bit windows over the limbs of exp, most significant first
+MontgomeryContext::Residue MontgomeryContext::Pow(const Residue& base,
+                                                  const BigInt& exp) const {
+  assert(exp >= 0);
+
+  std::array<Residue, 1 << kPowWindowBits> table;
+  table[0] = one_;
+  table[1] = base;
+  for (std::size_t i = 2; i < table.size(); ++i) {
+    Mul(table[i], table[i - 1], base);
+  }
+
+  Residue res = one_;
+  bool started = false;
+
+  for (auto it = exp.digits_.rbegin(); it != exp.digits_.rend(); ++it) {
+    for (int shift = kLimbBits - kPowWindowBits; shift >= 0;
+         shift -= kPowWindowBits) {
+      if (started) {
+        for (int i = 0; i < kPowWindowBits; ++i) {
+          Mul(res, res, res);
+        }
+      }
+
+      uint32_t window = (*it >> shift) & ((1u << kPowWindowBits) - 1);
+      if (window != 0) {
+        Mul(res, res, table[window]);
+        started = true;
+      }
+    }
+  }
+
+  return res;
+}
+
+bool IsProbablePrime(const BigInt& n, int extra_rounds) {
+  if (n < 2) {
+    return false;
+  }
+  if (!n.TestBit(0)) {
+    return n == 2;
+  }
+
+  for (const auto& group : SmallPrimeGroups()) {
+    uint32_t rem = n.ModLimb(group.product);
+    for (uint32_t p : group.primes) {
+      if (rem % p == 0) {
+        return n == p;
+      }
+    }
+  }
+
+  if (n < kSmallPrimeLimit * kSmallPrimeLimit) {
+    return true;
+  }
+
+  MontgomeryContext ctx(n);
+  Residue minus_one = ctx.ToResidue(-1);
+  BigInt d = n - 1;
+  int s = SplitPowerOfTwo(d);
+
+  if (!StrongProbablePrime(ctx, ctx.ToResidue(2), d, s, minus_one)) {
+    return false;
+  }
+
+  int64_t disc = SelfridgeD(n);
+  if (disc == 0 || !StrongLucasProbablePrime(ctx, disc)) {
+    return false;
+  }
+
+  // Bases are derived from n, so the answer is reproducible
+  std::mt19937_64 rng(n.Hash());
+  BigInt base_range = n - 3;
+
+  for (int i = 0; i < extra_rounds; ++i) {
+    Residue base = ctx.ToResidue(RandomBelow(base_range, rng) + 2);
+    if (!StrongProbablePrime(ctx, base, d, s, minus_one)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+BigInt NextPrime(const BigInt& n) {
+  return NextPrimes(n, 1, 1).front();
+}
+
+std::vector<BigInt> NextPrimes(const BigInt& n, std::size_t count,
+                               unsigned threads) {
+  if (threads == 0) {
+    threads = ParallelThreads();
+  }
+
+  std::vector<BigInt> primes;
+  BigInt cand = std::max(n + 1, BigInt(2));
+
+  // The sieve would strike out the small primes themselves
+  for (; primes.size() < count && cand <= kSmallPrimeLimit; ++cand) {
+    if (IsProbablePrime(cand)) {
+      primes.push_back(cand);
+    }
+  }
+
+  if (primes.size() == count) {
+    return primes;
+  }
+
+  if (!cand.TestBit(0)) {
+    ++cand;
+  }
+
+  CandidateSieve sieve(std::move(cand));
+  std::size_t batch_size = (threads == 1) ? 1 : threads * kBatchPerThread;
+  std::vector<char> is_prime;
+
+  while (primes.size() < count) {
+    std::vector<BigInt> survivors = sieve.NextWindow();
+    std::span<const BigInt> rest(survivors);
+
+    while (!rest.empty() && primes.size() < count) {
+      auto batch = rest.first(std::min(rest.size(), batch_size));
+      rest = rest.subspan(batch.size());
+
+      is_prime.assign(batch.size(), 0);
+      TestCandidates(batch, is_prime, threads);
+
+      for (std::size_t i = 0; i < batch.size() && primes.size() < count; ++i) {
+        if (is_prime[i]) {
+          primes.push_back(batch[i]);
+        }
+      }
+    }
+  }
+
+  return primes;
+}
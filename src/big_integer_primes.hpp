@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "big_integer.hpp"
+
+// Montgomery arithmetic modulo a fixed odd modulus > 1. Residues hold
+// val * R mod m for R = 2^(32 * limbs), so multiplications reduce without
+// any division.
+class MontgomeryContext {
+ public:
+  // Always exactly as many limbs as the modulus, leading zeros included
+  using Residue = Limbs;
+
+  explicit MontgomeryContext(const BigInt& modulus);
+
+  const BigInt& Modulus() const { return modulus_; }
+  const Residue& One() const { return one_; }
+
+  Residue ToResidue(const BigInt& val) const;
+  BigInt FromResidue(const Residue& val) const;
+
+  // dst may alias the operands
+  void Mul(Residue& dst, const Residue& lhs, const Residue& rhs) const;
+  void Add(Residue& dst, const Residue& lhs, const Residue& rhs) const;
+  void Sub(Residue& dst, const Residue& lhs, const Residue& rhs) const;
+  void Half(Residue& val) const;
+
+  // exp must be non-negative
+  Residue Pow(const Residue& base, const BigInt& exp) const;
+  BigInt Pow(const BigInt& base, const BigInt& exp) const {
+    return FromResidue(Pow(ToResidue(base), exp));
+  }
+
+ private:
+  BigInt modulus_;
+  uint32_t inv_;  // -m^-1 mod 2^32
+  Residue one_;
+  Residue r2_;  // R^2 mod m, not a residue itself
+};
+
+// Baillie-PSW: trial division by small primes, a base 2 strong probable
+// prime test and a strong Lucas test. No composite passing it is known,
+// extra_rounds adds Miller-Rabin rounds with pseudo-random bases.
+bool IsProbablePrime(const BigInt& n, int extra_rounds = 0);
+
+// Smallest probable prime > n
+BigInt NextPrime(const BigInt& n);
+
+// The count smallest probable primes > n. Candidates surviving the sieve
+// are tested in `threads` tasks on the shared worker pool, 0 means one per
+// pool thread.
+std::vector<BigInt> NextPrimes(const BigInt& n, std::size_t count,
+                               unsigned threads = 0);
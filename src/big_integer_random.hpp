@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+
+#include "big_integer.hpp"
+
+// Uniform random BigInts with limbs filled straight from any
+// UniformRandomBitGenerator, no string or division round trips. Generators
+// with a full 32- or 64-bit range are used raw, others go through
+// std::uniform_int_distribution.
+class BigIntRandom {
+ public:
+  // Uniform in [0, 2^bits)
+  template <std::uniform_random_bit_generator Rng>
+  static void AssignBits(BigInt& dst, uint64_t bits, Rng& rng) {
+    std::size_t limbs = (bits + 31) / 32;
+    dst.digits_.resize(limbs);
+    Fill(dst.digits_.data(), limbs, rng);
+
+    if (bits % 32 != 0) {
+      dst.digits_.back() &= (uint32_t{1} << (bits % 32)) - 1;
+    }
+    Trim(dst);
+  }
+
+  // Uniform in [0, bound), bound > 0. The top limb is drawn first under the
+  // mask of the bound's top bits, so a round is rejected after one draw
+  // in most cases and accepted with probability over 1/2.
+  template <std::uniform_random_bit_generator Rng>
+  static void AssignBelow(BigInt& dst, const BigInt& bound, Rng& rng) {
+    assert(bound > 0);
+    assert(&dst != &bound);
+
+    const Limbs& limit = bound.digits_;
+    std::size_t len = limit.size();
+    uint32_t top_limit = limit.back();
+    uint32_t top_mask = UINT32_MAX >> std::countl_zero(top_limit);
+
+    dst.digits_.resize(len);
+    for (;;) {
+      uint32_t top = 0;
+      Fill(&top, 1, rng);
+      top &= top_mask;
+      if (top > top_limit) {
+        continue;
+      }
+
+      dst.digits_.back() = top;
+      Fill(dst.digits_.data(), len - 1, rng);
+      if (top < top_limit || std::lexicographical_compare(
+                                 dst.digits_.rbegin() + 1, dst.digits_.rend(),
+                                 limit.rbegin() + 1, limit.rend())) {
+        break;
+      }
+    }
+    Trim(dst);
+  }
+
+ private:
+  template <std::uniform_random_bit_generator Rng>
+  static void Fill(uint32_t* out, std::size_t count, Rng& rng) {
+    if constexpr (Rng::min() == 0 && Rng::max() == UINT64_MAX) {
+      for (; count >= 2; count -= 2, out += 2) {
+        auto val = static_cast<uint64_t>(rng());
+        out[0] = static_cast<uint32_t>(val);
+        out[1] = static_cast<uint32_t>(val >> 32);
+      }
+      if (count != 0) {
+        *out = static_cast<uint32_t>(rng());
+      }
+    } else if constexpr (Rng::min() == 0 && Rng::max() == UINT32_MAX) {
+      std::generate_n(out, count,
+                      [&] { return static_cast<uint32_t>(rng()); });
+    } else {
+      std::uniform_int_distribution<uint32_t> dist;
+      std::generate_n(out, count, [&] { return dist(rng); });
+    }
+  }
+
+  static void Trim(BigInt& dst) {
+    while (!dst.digits_.empty() && dst.digits_.back() == 0) {
+      dst.digits_.pop_back();
+    }
+    dst.sign_ = dst.digits_.empty() ? BigInt::Sign::Zero
+                                    : BigInt::Sign::Positive;
+  }
+};
+
+template <std::uniform_random_bit_generator Rng>
+BigInt RandomBits(uint64_t bits, Rng& rng) {
+  BigInt res;
+  BigIntRandom::AssignBits(res, bits, rng);
+  return res;
+}
+
+template <std::uniform_random_bit_generator Rng>
+BigInt RandomBelow(const BigInt& bound, Rng& rng) {
+  BigInt res;
+  BigIntRandom::AssignBelow(res, bound, rng);
+  return res;
+}
+
+// Batch variants refill every element in place, reusing its limbs, so a
+// warmed-up buffer generates without touching the allocator
+template <std::uniform_random_bit_generator Rng>
+void RandomBits(std::span<BigInt> out, uint64_t bits, Rng& rng) {
+  for (BigInt& val : out) {
+    BigIntRandom::AssignBits(val, bits, rng);
+  }
+}
+
+template <std::uniform_random_bit_generator Rng>
+void RandomBelow(std::span<BigInt> out, const BigInt& bound, Rng& rng) {
+  for (BigInt& val : out) {
+    BigIntRandom::AssignBelow(val, bound, rng);
+  }
+}
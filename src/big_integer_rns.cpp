@@ -0,0 +1,255 @@
+#include "big_integer_rns.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "big_integer_parallel.hpp"
+#include "big_integer_primes.hpp"
+
+namespace {
+constexpr uint32_t kMaxPrime = (uint32_t{1} << 31) - 1;
+constexpr std::size_t kMinPrimeBits = 30;
+
+// Channels per pool task, fewer are not worth the hand-off
+constexpr std::size_t kMinParallelChannels = std::size_t{1} << 14;
+
+// Subtrees over fewer primes are converted on the calling thread, larger
+// ones hand their two halves to the shared pool
+constexpr std::size_t kMinParallelPrimes = 256;
+
+uint32_t MulMod(uint32_t lhs, uint32_t rhs, uint32_t mod) {
+  return static_cast<uint32_t>(static_cast<uint64_t>(lhs) * rhs % mod);
+}
+
+uint32_t InvMod(uint32_t val, uint32_t prime) {
+  uint32_t res = 1;
+  for (uint32_t exp = prime - 2; exp > 0; exp >>= 1) {
+    if (exp & 1) {
+      res = MulMod(res, val, prime);
+    }
+    val = MulMod(val, val, prime);
+  }
+  return res;
+}
+
+// Splits the channels between the pool workers once there are enough of
+// them, shorter loops are done before a worker would even wake up
+template <typename Fn>
+void ForEachChannel(std::size_t size, Fn fn) {
+  std::size_t parts = std::min<std::size_t>(ParallelThreads(),
+                                            size / kMinParallelChannels);
+  if (parts <= 1) {
+    fn(0, size);
+    return;
+  }
+
+  std::size_t chunk = (size + parts - 1) / parts;
+  ParallelFor(parts, [&](std::size_t part) {
+    fn(part * chunk, std::min(size, (part + 1) * chunk));
+  });
+}
+};  // namespace
+
+RnsBasis::RnsBasis(std::vector<uint32_t> primes)
+    : primes_(std::move(primes)),
+      crt_coeffs_(primes_.size()),
+      tree_(4 * std::max<std::size_t>(primes_.size(), 1)) {
+  assert(!primes_.empty());
+
+  BuildTree(1, 0, primes_.size());
+  half_modulus_ = Modulus() / 2;
+  BuildCrtCoeffs(1, 1, 0, primes_.size());
+}
+
+std::shared_ptr<const RnsBasis> RnsBasis::FromPrimes(
+    std::vector<uint32_t> primes) {
+  std::vector<uint32_t> sorted = primes;
+  std::sort(sorted.begin(), sorted.end());
+
+  bool valid = !sorted.empty() && sorted.back() <= kMaxPrime &&
+               std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+  for (std::size_t i = 0; i < sorted.size() && valid; ++i) {
+    valid = IsProbablePrime(sorted[i]);
+  }
+
+  if (!valid) {
+    return nullptr;
+  }
+  return std::shared_ptr<const RnsBasis>(new RnsBasis(std::move(primes)));
+}
+
+// Every candidate is above 2^30, so 30 bits per prime is a safe count
+std::shared_ptr<const RnsBasis> RnsBasis::ForBits(std::size_t bits) {
+  std::size_t count = (bits + 2 + kMinPrimeBits - 1) / kMinPrimeBits;
+  std::vector<uint32_t> primes;
+
+  for (uint32_t cand = kMaxPrime; primes.size() < count; cand -= 2) {
+    if (IsProbablePrime(cand)) {
+      primes.push_back(cand);
+    }
+  }
+
+  return std::shared_ptr<const RnsBasis>(new RnsBasis(std::move(primes)));
+}
+
+const BigInt& RnsBasis::BuildTree(std::size_t node, std::size_t lo,
+                                  std::size_t hi) {
+  if (hi - lo == 1) {
+    tree_[node] = primes_[lo];
+  } else {
+    std::size_t mid = lo + (hi - lo) / 2;
+    Mul(tree_[node], BuildTree(2 * node, lo, mid),
+        BuildTree(2 * node + 1, mid, hi));
+  }
+  return tree_[node];
+}
+
+// cofactor = (M / tree_[node]) mod tree_[node]. For node = left * right
+// M / left = (M / node) * right, so the children get their cofactors from
+// the parent's one without touching M.
+void RnsBasis::BuildCrtCoeffs(const BigInt& cofactor, std::size_t node,
+                              std::size_t lo, std::size_t hi) {
+  if (hi - lo == 1) {
+    crt_coeffs_[lo] = InvMod(cofactor.ModLimb(primes_[lo]), primes_[lo]);
+    return;
+  }
+
+  std::size_t mid = lo + (hi - lo) / 2;
+  const BigInt& left = tree_[2 * node];
+  const BigInt& right = tree_[2 * node + 1];
+
+  BuildCrtCoeffs(cofactor % left * (right % left) % left, 2 * node, lo, mid);
+  BuildCrtCoeffs(cofactor % right * (left % right) % right, 2 * node + 1, mid,
+                 hi);
+}
+
+// val < tree_[node], remainders shrink on the way down
+void RnsBasis::Reduce(std::vector<uint32_t>& residues, const BigInt& val,
+                      std::size_t node, std::size_t lo,
+                      std::size_t hi) const {
+  if (hi - lo == 1) {
+    residues[lo] = val.ModLimb(primes_[lo]);
+    return;
+  }
+
+  std::size_t mid = lo + (hi - lo) / 2;
+  auto reduce_half = [&](std::size_t half) {
+    std::size_t child = 2 * node + half;
+    Reduce(residues, val % tree_[child], child, half ? mid : lo,
+           half ? hi : mid);
+  };
+
+  if (hi - lo >= kMinParallelPrimes) {
+    ParallelFor(2, reduce_half);
+  } else {
+    reduce_half(0);
+    reduce_half(1);
+  }
+}
+
+// sum of (r_i * c_i mod p_i) * M / p_i over the range, built bottom-up as
+// left * M_right + right * M_left
+BigInt RnsBasis::Combine(const std::vector<uint32_t>& residues,
+                         std::size_t node, std::size_t lo,
+                         std::size_t hi) const {
+  if (hi - lo == 1) {
+    return MulMod(residues[lo], crt_coeffs_[lo], primes_[lo]);
+  }
+
+  std::size_t mid = lo + (hi - lo) / 2;
+  BigInt halves[2];
+  auto combine_half = [&](std::size_t half) {
+    halves[half] = Combine(residues, 2 * node + half, half ? mid : lo,
+                           half ? hi : mid);
+  };
+
+  if (hi - lo >= kMinParallelPrimes) {
+    ParallelFor(2, combine_half);
+  } else {
+    combine_half(0);
+    combine_half(1);
+  }
+
+  BigInt& left = halves[0];
+  BigInt& right = halves[1];
+  Mul(left, left, tree_[2 * node + 1]);
+  Mul(right, right, tree_[2 * node]);
+  return left += right;
+}
+
+RnsInt::RnsInt(std::shared_ptr<const RnsBasis> basis)
+    : basis_(std::move(basis)), residues_(basis_->Size(), 0) {}
+
+RnsInt::RnsInt(std::shared_ptr<const RnsBasis> basis, const BigInt& val)
+    : RnsInt(std::move(basis)) {
+  BigInt rem = val % basis_->Modulus();
+  if (rem < 0) {
+    rem += basis_->Modulus();
+  }
+  basis_->Reduce(residues_, rem, 1, 0, basis_->Size());
+}
+
+BigInt RnsInt::ToBigInt() const {
+  BigInt res = basis_->Combine(residues_, 1, 0, basis_->Size());
+  res %= basis_->Modulus();
+  if (res > basis_->half_modulus_) {
+    res -= basis_->Modulus();
+  }
+  return res;
+}
+
+RnsInt& RnsInt::operator+=(const RnsInt& other) {
+  assert(basis_ == other.basis_);
+
+  const uint32_t* primes = basis_->primes_.data();
+  const uint32_t* rhs = other.residues_.data();
+  uint32_t* lhs = residues_.data();
+
+  ForEachChannel(residues_.size(), [=](std::size_t lo, std::size_t hi) {
+    for (std::size_t i = lo; i < hi; ++i) {
+      uint32_t sum = lhs[i] + rhs[i];
+      lhs[i] = (sum >= primes[i]) ? sum - primes[i] : sum;
+    }
+  });
+  return *this;
+}
+
+RnsInt& RnsInt::operator-=(const RnsInt& other) {
+  assert(basis_ == other.basis_);
+
+  const uint32_t* primes = basis_->primes_.data();
+  const uint32_t* rhs = other.residues_.data();
+  uint32_t* lhs = residues_.data();
+
+  ForEachChannel(residues_.size(), [=](std::size_t lo, std::size_t hi) {
+    for (std::size_t i = lo; i < hi; ++i) {
+      uint32_t diff = lhs[i] - rhs[i];
+      lhs[i] = (lhs[i] < rhs[i]) ? diff + primes[i] : diff;
+    }
+  });
+  return *this;
+}
+
+RnsInt& RnsInt::operator*=(const RnsInt& other) {
+  assert(basis_ == other.basis_);
+
+  const uint32_t* primes = basis_->primes_.data();
+  const uint32_t* rhs = other.residues_.data();
+  uint32_t* lhs = residues_.data();
+
+  ForEachChannel(residues_.size(), [=](std::size_t lo, std::size_t hi) {
+    for (std::size_t i = lo; i < hi; ++i) {
+      lhs[i] = MulMod(lhs[i], rhs[i], primes[i]);
+    }
+  });
+  return *this;
+}
+
+RnsInt RnsInt::operator-() const {
+  RnsInt res(basis_);
+  return res -= *this;
+}
+
+bool RnsInt::operator==(const RnsInt& other) const {
+  return basis_ == other.basis_ && residues_ == other.residues_;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "big_integer.hpp"
+
+// A set of distinct primes below 2^31 with the subproduct tree used for
+// conversions. Sums of two residues fit in 32 bits, so element-wise loops
+// stay branch-free and vectorizable.
+class RnsBasis {
+ public:
+  // nullptr unless primes is non-empty and holds distinct primes below 2^31
+  static std::shared_ptr<const RnsBasis> FromPrimes(
+      std::vector<uint32_t> primes);
+
+  // Primes below 2^31, largest first, whose product exceeds 2^(bits + 1):
+  // every value with abs(val) < 2^bits round-trips
+  static std::shared_ptr<const RnsBasis> ForBits(std::size_t bits);
+
+  std::size_t Size() const { return primes_.size(); }
+  const std::vector<uint32_t>& Primes() const { return primes_; }
+  const BigInt& Modulus() const { return tree_[1]; }
+
+ private:
+  explicit RnsBasis(std::vector<uint32_t> primes);
+
+  const BigInt& BuildTree(std::size_t node, std::size_t lo, std::size_t hi);
+  void BuildCrtCoeffs(const BigInt& cofactor, std::size_t node,
+                      std::size_t lo, std::size_t hi);
+  void Reduce(std::vector<uint32_t>& residues, const BigInt& val,
+              std::size_t node, std::size_t lo, std::size_t hi) const;
+  BigInt Combine(const std::vector<uint32_t>& residues, std::size_t node,
+                 std::size_t lo, std::size_t hi) const;
+
+  std::vector<uint32_t> primes_;
+  // (M / p_i)^-1 mod p_i
+  std::vector<uint32_t> crt_coeffs_;
+  // Products over index ranges, node 1 is everything, 2n and 2n + 1 halves
+  std::vector<BigInt> tree_;
+  BigInt half_modulus_;
+
+  friend class RnsInt;
+};
+
+// Residue number system integer: the value modulo each prime of a basis.
+// Add, sub and mul are carry-free and work channel by channel; values
+// are reconstructed in (-M / 2, M / 2] by CRT.
+class RnsInt {
+ public:
+  explicit RnsInt(std::shared_ptr<const RnsBasis> basis);
+  RnsInt(std::shared_ptr<const RnsBasis> basis, const BigInt& val);
+
+  BigInt ToBigInt() const;
+
+  const std::shared_ptr<const RnsBasis>& Basis() const { return basis_; }
+  const std::vector<uint32_t>& Residues() const { return residues_; }
+
+  // Operands must share the basis object
+  RnsInt& operator+=(const RnsInt& other);
+  RnsInt& operator-=(const RnsInt& other);
+  RnsInt& operator*=(const RnsInt& other);
+  RnsInt operator-() const;
+
+  bool operator==(const RnsInt& other) const;
+
+ private:
+  std::shared_ptr<const RnsBasis> basis_;
+  std::vector<uint32_t> residues_;
+};
+
+static RnsInt operator+(RnsInt self, const RnsInt& other) {
+  return self += other;
+}
+
+static RnsInt operator-(RnsInt self, const RnsInt& other) {
+  return self -= other;
+}
+
+static RnsInt operator*(RnsInt self, const RnsInt& other) {
+  return self *= other;
+}
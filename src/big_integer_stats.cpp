@@ -0,0 +1,230 @@
+#include "big_integer_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <mutex>
+
+const char* BigIntOpName(BigIntOp op) {
+  switch (op) {
+    case BigIntOp::Add:
+      return "add";
+    case BigIntOp::Sub:
+      return "sub";
+    case BigIntOp::Mul:
+      return "mul";
+    case BigIntOp::Sqr:
+      return "sqr";
+    case BigIntOp::DivMod:
+      return "divmod";
+    case BigIntOp::NativeAdd:
+      return "native_add";
+    case BigIntOp::NativeMul:
+      return "native_mul";
+    case BigIntOp::NativeDivMod:
+      return "native_divmod";
+    case BigIntOp::ToString:
+      return "to_string";
+    case BigIntOp::Parse:
+      return "parse";
+    case BigIntOp::Count:
+      break;
+  }
+
+  return "unknown";
+}
+
+#ifdef BIGINT_STATS
+
+namespace {
+using Counter = std::atomic<uint64_t>;
+
+// Written only by the owning thread, read by snapshots
+struct ThreadCounters {
+  std::array<Counter, kBigIntOpCount> calls{};
+  std::array<Counter, kBigIntOpCount> limbs_total{};
+  std::array<std::array<Counter, kSizeBuckets>, kBigIntOpCount> limbs_log2{};
+  Counter div_steps{};
+  Counter div_add_backs{};
+  Counter allocations{};
+  Counter allocated_bytes{};
+};
+
+void Bump(Counter& counter, uint64_t delta) {
+  counter.store(counter.load(std::memory_order_relaxed) + delta,
+                std::memory_order_relaxed);
+}
+
+uint64_t Load(const Counter& counter) {
+  return counter.load(std::memory_order_relaxed);
+}
+
+void AddTo(BigIntStats& stats, const ThreadCounters& counters) {
+  for (std::size_t op = 0; op < kBigIntOpCount; ++op) {
+    stats.ops[op].calls += Load(counters.calls[op]);
+    stats.ops[op].limbs_total += Load(counters.limbs_total[op]);
+    for (std::size_t k = 0; k < kSizeBuckets; ++k) {
+      stats.ops[op].limbs_log2[k] += Load(counters.limbs_log2[op][k]);
+    }
+  }
+
+  stats.div_steps += Load(counters.div_steps);
+  stats.div_add_backs += Load(counters.div_add_backs);
+  stats.allocations += Load(counters.allocations);
+  stats.allocated_bytes += Load(counters.allocated_bytes);
+}
+
+std::mutex registry_mutex;
+std::vector<ThreadCounters*> registry;
+BigIntStats retired;  // threads that already exited
+
+// Registers thread counters on first use, folds them on thread exit
+struct ThreadSlot {
+  ThreadCounters counters;
+
+  ThreadSlot() {
+    std::lock_guard lock(registry_mutex);
+    registry.push_back(&counters);
+  }
+
+  ~ThreadSlot() {
+    std::lock_guard lock(registry_mutex);
+    AddTo(retired, counters);
+    registry.erase(std::find(registry.begin(), registry.end(), &counters));
+  }
+
+  ThreadSlot(const ThreadSlot&) = delete;
+  ThreadSlot& operator=(const ThreadSlot&) = delete;
+};
+
+ThreadCounters& Local() {
+  static thread_local ThreadSlot slot;
+  return slot.counters;
+}
+
+void Clear(ThreadCounters& counters) {
+  auto reset = [](Counter& counter) {
+    counter.store(0, std::memory_order_relaxed);
+  };
+
+  std::for_each(counters.calls.begin(), counters.calls.end(), reset);
+  std::for_each(counters.limbs_total.begin(), counters.limbs_total.end(),
+                reset);
+  for (auto& buckets : counters.limbs_log2) {
+    std::for_each(buckets.begin(), buckets.end(), reset);
+  }
+
+  reset(counters.div_steps);
+  reset(counters.div_add_backs);
+  reset(counters.allocations);
+  reset(counters.allocated_bytes);
+}
+};  // namespace
+
+void RecordStatsOp(BigIntOp op, std::size_t limbs) {
+  auto& counters = Local();
+  auto index = static_cast<std::size_t>(op);
+  std::size_t bucket =
+      std::min<std::size_t>(std::bit_width(limbs), kSizeBuckets - 1);
+
+  Bump(counters.calls[index], 1);
+  Bump(counters.limbs_total[index], limbs);
+  Bump(counters.limbs_log2[index][bucket], 1);
+}
+
+void RecordStatsDivSteps(std::size_t steps) {
+  Bump(Local().div_steps, steps);
+}
+
+void RecordStatsDivAddBack() { Bump(Local().div_add_backs, 1); }
+
+void RecordStatsAllocation(std::size_t bytes) {
+  auto& counters = Local();
+  Bump(counters.allocations, 1);
+  Bump(counters.allocated_bytes, bytes);
+}
+
+BigIntStats StatsSnapshot() {
+  std::lock_guard lock(registry_mutex);
+  BigIntStats stats = retired;
+
+  for (const auto* counters : registry) {
+    AddTo(stats, *counters);
+  }
+
+  return stats;
+}
+
+// Counters of running threads are zeroed from outside: increments racing
+// with the reset may be lost, which is fine for statistics
+void ResetStats() {
+  std::lock_guard lock(registry_mutex);
+  retired = BigIntStats{};
+
+  for (auto* counters : registry) {
+    Clear(*counters);
+  }
+}
+
+#else
+
+BigIntStats StatsSnapshot() { return {}; }
+void ResetStats() {}
+
+#endif
+
+void WriteStatsJson(std::ostream& stream, const BigIntStats& stats) {
+  stream << "{\"ops\":{";
+
+  for (std::size_t op = 0; op < kBigIntOpCount; ++op) {
+    const auto& op_stats = stats.ops[op];
+    stream << (op == 0 ? "" : ",") << '"'
+           << BigIntOpName(static_cast<BigIntOp>(op))
+           << "\":{\"calls\":" << op_stats.calls
+           << ",\"limbs_total\":" << op_stats.limbs_total
+           << ",\"limbs_log2\":[";
+
+    for (std::size_t k = 0; k < kSizeBuckets; ++k) {
+      stream << (k == 0 ? "" : ",") << op_stats.limbs_log2[k];
+    }
+    stream << "]}";
+  }
+
+  stream << "},\"div_steps\":" << stats.div_steps
+         << ",\"div_add_backs\":" << stats.div_add_backs
+         << ",\"allocations\":" << stats.allocations
+         << ",\"allocated_bytes\":" << stats.allocated_bytes << "}";
+}
+
+// Text exposition format, limb histograms use le = 2^k - 1 buckets
+void WriteStatsPrometheus(std::ostream& stream, const BigIntStats& stats) {
+  stream << "# TYPE bigint_op_limbs histogram\n";
+
+  for (std::size_t op = 0; op < kBigIntOpCount; ++op) {
+    const auto& op_stats = stats.ops[op];
+    const char* name = BigIntOpName(static_cast<BigIntOp>(op));
+    uint64_t cumulative = 0;
+
+    for (std::size_t k = 0; k + 1 < kSizeBuckets; ++k) {
+      cumulative += op_stats.limbs_log2[k];
+      stream << "bigint_op_limbs_bucket{op=\"" << name << "\",le=\""
+             << ((uint64_t{1} << k) - 1) << "\"} " << cumulative << '\n';
+    }
+
+    stream << "bigint_op_limbs_bucket{op=\"" << name << "\",le=\"+Inf\"} "
+           << op_stats.calls << '\n'
+           << "bigint_op_limbs_sum{op=\"" << name << "\"} "
+           << op_stats.limbs_total << '\n'
+           << "bigint_op_limbs_count{op=\"" << name << "\"} "
+           << op_stats.calls << '\n';
+  }
+
+  stream << "# TYPE bigint_div_steps_total counter\n"
+         << "bigint_div_steps_total " << stats.div_steps << '\n'
+         << "# TYPE bigint_div_add_backs_total counter\n"
+         << "bigint_div_add_backs_total " << stats.div_add_backs << '\n'
+         << "# TYPE bigint_allocations_total counter\n"
+         << "bigint_allocations_total " << stats.allocations << '\n'
+         << "# TYPE bigint_allocated_bytes_total counter\n"
+         << "bigint_allocated_bytes_total " << stats.allocated_bytes << '\n';
+}
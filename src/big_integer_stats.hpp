@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Opt-in instrumentation, enabled by defining BIGINT_STATS (CMake option of
+// the same name). When it is off all hooks expand to nothing and limbs use
+// the plain std::allocator; the snapshot API stays and reports zeros.
+
+#ifdef BIGINT_STATS
+constexpr bool kBigIntStatsEnabled = true;
+#else
+constexpr bool kBigIntStatsEnabled = false;
+#endif
+
+enum class BigIntOp : uint8_t {
+  Add,
+  Sub,
+  Mul,
+  Sqr,
+  DivMod,
+  NativeAdd,
+  NativeMul,
+  NativeDivMod,
+  ToString,
+  Parse,
+  Count
+};
+
+constexpr std::size_t kBigIntOpCount =
+    static_cast<std::size_t>(BigIntOp::Count);
+
+// Bucket k holds operand sizes in [2^(k-1), 2^k) limbs, bucket 0 is zero
+constexpr std::size_t kSizeBuckets = 48;
+
+struct BigIntOpStats {
+  uint64_t calls = 0;
+  uint64_t limbs_total = 0;
+  std::array<uint64_t, kSizeBuckets> limbs_log2{};
+};
+
+struct BigIntStats {
+  std::array<BigIntOpStats, kBigIntOpCount> ops{};
+  uint64_t div_steps = 0;      // quotient limbs of long division
+  uint64_t div_add_backs = 0;  // quotient digit estimate was one too large
+  uint64_t allocations = 0;    // limb buffer (re)allocations
+  uint64_t allocated_bytes = 0;
+};
+
+const char* BigIntOpName(BigIntOp op);
+
+// Sum over all threads, including finished ones
+BigIntStats StatsSnapshot();
+void ResetStats();
+
+void WriteStatsJson(std::ostream& stream, const BigIntStats& stats);
+void WriteStatsPrometheus(std::ostream& stream, const BigIntStats& stats);
+
+#ifdef BIGINT_STATS
+
+// Per-thread, lock free
+void RecordStatsOp(BigIntOp op, std::size_t limbs);
+void RecordStatsDivSteps(std::size_t steps);
+void RecordStatsDivAddBack();
+void RecordStatsAllocation(std::size_t bytes);
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U>& /*other*/) {}
+
+  T* allocate(std::size_t count) {
+    RecordStatsAllocation(count * sizeof(T));
+    return std::allocator<T>{}.allocate(count);
+  }
+
+  void deallocate(T* ptr, std::size_t count) {
+    std::allocator<T>{}.deallocate(ptr, count);
+  }
+
+  friend bool operator==(const CountingAllocator& /*lhs*/,
+                         const CountingAllocator& /*rhs*/) {
+    return true;
+  }
+};
+
+using LimbAllocator = CountingAllocator<uint32_t>;
+
+#define BIGINT_STATS_OP(op, limbs) RecordStatsOp(BigIntOp::op, limbs)
+#define BIGINT_STATS_DIV_STEPS(steps) RecordStatsDivSteps(steps)
+#define BIGINT_STATS_DIV_ADD_BACK() RecordStatsDivAddBack()
+
+#else
+
+using LimbAllocator = std::allocator<uint32_t>;
+
+#define BIGINT_STATS_OP(op, limbs) static_cast<void>(0)
+#define BIGINT_STATS_DIV_STEPS(steps) static_cast<void>(0)
+#define BIGINT_STATS_DIV_ADD_BACK() static_cast<void>(0)
+
+#endif
+
+using Limbs = std::vector<uint32_t, LimbAllocator>;
@@ -0,0 +1,115 @@
+#include "big_integer_tuning.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+std::atomic<std::size_t> karatsuba_mul{BIGINT_KARATSUBA_MUL_THRESHOLD};
+std::atomic<std::size_t> karatsuba_sqr{BIGINT_KARATSUBA_SQR_THRESHOLD};
+std::atomic<std::size_t> radix_conversion{BIGINT_RADIX_CONVERSION_THRESHOLD};
+std::atomic<std::size_t> newton_div{BIGINT_NEWTON_DIV_THRESHOLD};
+
+TuneConfigStatus LoadFromEnv() {
+  const char* path = std::getenv("BIGINT_TUNE_CONFIG");
+  if (path == nullptr) {
+    return TuneConfigStatus::NotSet;
+  }
+
+  std::ifstream config(path);
+  if (!config) {
+    std::cerr << "bigint: cannot read BIGINT_TUNE_CONFIG " << path
+              << ", using default thresholds\n";
+    return TuneConfigStatus::Unreadable;
+  }
+
+  if (!LoadThresholds(config)) {
+    std::cerr << "bigint: malformed BIGINT_TUNE_CONFIG " << path
+              << ", using default thresholds\n";
+    return TuneConfigStatus::Malformed;
+  }
+
+  return TuneConfigStatus::Loaded;
+}
+
+// Parses one "key = value" line into thresholds, empty lines are fine
+bool ParseLine(std::string line, BigIntThresholds& thresholds) {
+  line = line.substr(0, line.find('#'));
+  std::size_t equals = line.find('=');
+
+  std::istringstream key_tokens(line.substr(0, equals));
+  std::string key;
+  if (!(key_tokens >> key)) {
+    return equals == std::string::npos;
+  }
+
+  std::istringstream value_tokens(
+      equals == std::string::npos ? "" : line.substr(equals + 1));
+  std::size_t value = 0;
+  std::string rest;
+
+  if (!(value_tokens >> value) || (key_tokens >> rest) ||
+      (value_tokens >> rest)) {
+    return false;
+  }
+
+  if (key == "karatsuba_mul") {
+    thresholds.karatsuba_mul = value;
+  } else if (key == "karatsuba_sqr") {
+    thresholds.karatsuba_sqr = value;
+  } else if (key == "radix_conversion") {
+    thresholds.radix_conversion = value;
+  } else if (key == "newton_div") {
+    thresholds.newton_div = value;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+const TuneConfigStatus kEnvStatus = LoadFromEnv();
+};  // namespace
+
+BigIntThresholds GetThresholds() {
+  return {karatsuba_mul.load(std::memory_order_relaxed),
+          karatsuba_sqr.load(std::memory_order_relaxed),
+          radix_conversion.load(std::memory_order_relaxed),
+          newton_div.load(std::memory_order_relaxed)};
+}
+
+void SetThresholds(const BigIntThresholds& thresholds) {
+  karatsuba_mul.store(thresholds.karatsuba_mul, std::memory_order_relaxed);
+  karatsuba_sqr.store(thresholds.karatsuba_sqr, std::memory_order_relaxed);
+  radix_conversion.store(thresholds.radix_conversion,
+                         std::memory_order_relaxed);
+  newton_div.store(thresholds.newton_div, std::memory_order_relaxed);
+}
+
+TuneConfigStatus EnvConfigStatus() {
+  return kEnvStatus;
+}
+
+bool LoadThresholds(std::istream& stream) {
+  BigIntThresholds thresholds = GetThresholds();
+  std::string line;
+
+  while (std::getline(stream, line)) {
+    if (!ParseLine(line, thresholds)) {
+      return false;
+    }
+  }
+
+  SetThresholds(thresholds);
+  return true;
+}
+
+void SaveThresholds(std::ostream& stream, const BigIntThresholds& thresholds) {
+  stream << "karatsuba_mul = " << thresholds.karatsuba_mul << '\n'
+         << "karatsuba_sqr = " << thresholds.karatsuba_sqr << '\n'
+         << "radix_conversion = " << thresholds.radix_conversion << '\n'
+         << "newton_div = " << thresholds.newton_div << '\n';
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+// Host-specific defaults generated by bigint_tune, if present
+#if __has_include("big_integer_tuned.hpp")
+#include "big_integer_tuned.hpp"
+#endif
+
+#ifndef BIGINT_KARATSUBA_MUL_THRESHOLD
+#define BIGINT_KARATSUBA_MUL_THRESHOLD 32
+#endif
+
+#ifndef BIGINT_KARATSUBA_SQR_THRESHOLD
+#define BIGINT_KARATSUBA_SQR_THRESHOLD 48
+#endif
+
+#ifndef BIGINT_RADIX_CONVERSION_THRESHOLD
+#define BIGINT_RADIX_CONVERSION_THRESHOLD 32
+#endif
+
+#ifndef BIGINT_NEWTON_DIV_THRESHOLD
+#define BIGINT_NEWTON_DIV_THRESHOLD 1024
+#endif
+
+// Operand sizes (in limbs) from which algorithms switch to the next tier
+struct BigIntThresholds {
+  std::size_t karatsuba_mul = BIGINT_KARATSUBA_MUL_THRESHOLD;
+  std::size_t karatsuba_sqr = BIGINT_KARATSUBA_SQR_THRESHOLD;
+  // Divide and conquer ToString / FromString for non-power-of-two radixes
+  std::size_t radix_conversion = BIGINT_RADIX_CONVERSION_THRESHOLD;
+  // Newton reciprocal DivMod, by divisor and quotient size
+  std::size_t newton_div = BIGINT_NEWTON_DIV_THRESHOLD;
+};
+
+// Process-wide, safe to change while other threads compute. On startup the
+// config file from BIGINT_TUNE_CONFIG env var is loaded, if set.
+BigIntThresholds GetThresholds();
+void SetThresholds(const BigIntThresholds& thresholds);
+
+enum class TuneConfigStatus { NotSet, Loaded, Unreadable, Malformed };
+
+// Outcome of the startup load. Unreadable and malformed configs are also
+// reported on stderr, the compiled-in defaults stay in effect.
+TuneConfigStatus EnvConfigStatus();
+
+// Config format is "key = value" per line, '#' starts a comment. Returns
+// false (and changes nothing) on unknown keys or malformed lines.
+bool LoadThresholds(std::istream& stream);
+void SaveThresholds(std::ostream& stream, const BigIntThresholds& thresholds);
@@ -0,0 +1,283 @@
+#include "big_rational.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+constexpr int kLimbBits = 32;
+
+// A quotient of at least this many limbs keeps more than 64 bits
+constexpr int64_t kDoubleQuotientLimbs = 4;
+
+BigInt PowerOfTen(std::size_t exp) {
+  return BigInt("1" + std::string(exp, '0'));
+}
+
+BigInt Abs(const BigInt& val) {
+  return (val < 0) ? -val : val;
+}
+
+int Signum(const BigInt& val) {
+  return (val > 0) - (val < 0);
+}
+};  // namespace
+
+BigRational::BigRational(BigInt num, BigInt den)
+    : num_(std::move(num)), den_(std::move(den)) {
+  assert(den_ != 0);
+
+  if (den_ < 0) {
+    num_ = -std::move(num_);
+    den_ = -std::move(den_);
+  }
+  normalized_ = (den_ == 1);
+}
+
+std::optional<BigRational> BigRational::FromString(std::string_view str) {
+  if (auto slash = str.find('/'); slash != std::string_view::npos) {
+    auto num = BigInt::FromString(str.substr(0, slash));
+    auto den = BigInt::FromString(str.substr(slash + 1));
+    if (!num || !den || *den == 0) {
+      return std::nullopt;
+    }
+
+    BigRational res(std::move(*num), std::move(*den));
+    res.Normalize();
+    return res;
+  }
+
+  auto dot = str.find('.');
+  if (dot == std::string_view::npos) {
+    auto num = BigInt::FromString(str);
+    if (!num) {
+      return std::nullopt;
+    }
+    return BigRational(std::move(*num));
+  }
+
+  std::string_view int_part = str.substr(0, dot);
+  std::string_view frac_part = str.substr(dot + 1);
+  bool has_sign = !int_part.empty() &&
+                  (int_part.front() == '-' || int_part.front() == '+');
+  if (frac_part.empty() || int_part.size() == (has_sign ? 1 : 0)) {
+    return std::nullopt;
+  }
+
+  auto num = BigInt::FromString(std::string(int_part) + std::string(frac_part));
+  if (!num || frac_part.front() == '-' || frac_part.front() == '+') {
+    return std::nullopt;
+  }
+
+  BigRational res(std::move(*num), PowerOfTen(frac_part.size()));
+  res.Normalize();
+  return res;
+}
+
+BigRational BigRational::FromDouble(double val) {
+  assert(std::isfinite(val));
+
+  int exp = 0;
+  double mantissa = std::frexp(val, &exp);
+  auto num = static_cast<int64_t>(std::ldexp(mantissa, 53));
+  exp -= 53;
+
+  BigInt power = 1;
+  auto abs_exp = static_cast<uint32_t>(std::abs(exp));
+  power.LeftShift(abs_exp / kLimbBits);
+  power *= uint64_t{1} << (abs_exp % kLimbBits);
+
+  BigRational res = (exp >= 0) ? BigRational(BigInt(num) * power)
+                               : BigRational(BigInt(num), std::move(power));
+  res.Normalize();
+  return res;
+}
+
+std::string BigRational::ToString() const {
+  if (den_ == 1) {
+    return num_.ToString();
+  }
+  return num_.ToString() + "/" + den_.ToString();
+}
+
+std::string BigRational::ToDecimalString(std::size_t digits) const {
+  BigInt quot;
+  BigInt rem;
+  DivMod(quot, rem, Abs(num_) * PowerOfTen(digits), den_);
+
+  if (rem * 2 >= den_) {
+    ++quot;
+  }
+
+  std::string str = quot.ToString();
+  if (str.size() <= digits) {
+    str.insert(0, digits + 1 - str.size(), '0');
+  }
+  if (digits > 0) {
+    str.insert(str.size() - digits, ".");
+  }
+  if (num_ < 0 && quot != 0) {
+    str.insert(0, "-");
+  }
+
+  return str;
+}
+
+// Scales by whole limbs so the truncated quotient keeps over 64 bits, a
+// non-zero remainder is folded into its lowest bit as the sticky bit.
+double BigRational::ToDouble() const {
+  if (num_ == 0) {
+    return 0.0;
+  }
+
+  int64_t shift = static_cast<int64_t>(den_.digits_.size()) -
+                  static_cast<int64_t>(num_.digits_.size()) +
+                  kDoubleQuotientLimbs;
+  BigInt num = num_;
+  BigInt den = den_;
+  if (shift >= 0) {
+    num.LeftShift(static_cast<uint32_t>(shift));
+  } else {
+    den.LeftShift(static_cast<uint32_t>(-shift));
+  }
+
+  BigInt quot;
+  BigInt rem;
+  DivMod(quot, rem, num, den);
+  if (rem != 0 && !quot.TestBit(0)) {
+    quot += (quot < 0) ? -1 : 1;
+  }
+
+  return std::ldexp(quot.ToDoubleSaturating(),
+                    static_cast<int>(-shift * kLimbBits));
+}
+
+void BigRational::Normalize() {
+  if (normalized_) {
+    return;
+  }
+
+  BigInt gcd = Gcd(num_, den_);
+  if (gcd != 1) {
+    num_ /= gcd;
+    den_ /= gcd;
+  }
+  normalized_ = true;
+}
+
+// For reduced a/b and c/d with d1 = gcd(b, d): t = a (d / d1) + c (b / d1),
+// d2 = gcd(t, d1), the sum is (t / d2) / ((b / d1) (d / d2)) in lowest terms
+BigRational& BigRational::operator+=(const BigRational& other) {
+  if (!other.normalized_) {
+    BigRational copy = other;
+    copy.Normalize();
+    return *this += copy;
+  }
+  Normalize();
+
+  BigInt d1 = Gcd(den_, other.den_);
+  if (d1 == 1) {
+    num_ = num_ * other.den_ + other.num_ * den_;
+    den_ *= other.den_;
+    return *this;
+  }
+
+  BigInt den_quot = den_ / d1;
+  BigInt t = num_ * (other.den_ / d1) + other.num_ * den_quot;
+  if (t == 0) {
+    *this = BigRational();
+    return *this;
+  }
+
+  BigInt d2 = Gcd(t, d1);
+  den_ = den_quot * (other.den_ / d2);
+  num_ = std::move(t);
+  if (d2 != 1) {
+    num_ /= d2;
+  }
+  return *this;
+}
+
+BigRational& BigRational::operator-=(const BigRational& other) {
+  return *this += -other;
+}
+
+// (a / b) (c / d) = ((a / g1) (c / g2)) / ((b / g2) (d / g1)) with
+// g1 = gcd(a, d), g2 = gcd(c, b), already in lowest terms
+BigRational& BigRational::operator*=(const BigRational& other) {
+  if (!other.normalized_) {
+    BigRational copy = other;
+    copy.Normalize();
+    return *this *= copy;
+  }
+  Normalize();
+
+  if (num_ == 0 || other.num_ == 0) {
+    *this = BigRational();
+    return *this;
+  }
+
+  BigInt g1 = Gcd(num_, other.den_);
+  BigInt g2 = Gcd(other.num_, den_);
+  BigInt num = (num_ / g1) * (other.num_ / g2);
+  den_ = (den_ / g2) * (other.den_ / g1);
+  num_ = std::move(num);
+  return *this;
+}
+
+BigRational& BigRational::operator/=(const BigRational& other) {
+  assert(other.num_ != 0);
+
+  BigRational inverse(other.den_, other.num_);
+  inverse.normalized_ = other.normalized_;
+  return *this *= inverse;
+}
+
+BigRational BigRational::operator-() const& {
+  BigRational res = *this;
+  res.num_ = -std::move(res.num_);
+  return res;
+}
+
+BigRational BigRational::operator-() && {
+  num_ = -std::move(num_);
+  return std::move(*this);
+}
+
+std::strong_ordering BigRational::operator<=>(const BigRational& other) const {
+  auto sign_cmp = Signum(num_) <=> Signum(other.num_);
+  if (sign_cmp != std::strong_ordering::equal || num_ == 0) {
+    return sign_cmp;
+  }
+
+  if (den_ == other.den_) {
+    return num_ <=> other.num_;
+  }
+
+  // A product of n and m limbs has n + m - 1 or n + m limbs
+  std::size_t lhs_size = num_.digits_.size() + other.den_.digits_.size();
+  std::size_t rhs_size = other.num_.digits_.size() + den_.digits_.size();
+  bool positive = (num_ > 0);
+
+  if (lhs_size >= rhs_size + 2) {
+    return positive ? std::strong_ordering::greater
+                    : std::strong_ordering::less;
+  }
+  if (rhs_size >= lhs_size + 2) {
+    return positive ? std::strong_ordering::less
+                    : std::strong_ordering::greater;
+  }
+
+  return num_ * other.den_ <=> other.num_ * den_;
+}
+
+bool BigRational::operator==(const BigRational& other) const {
+  if (normalized_ && other.normalized_) {
+    return num_ == other.num_ && den_ == other.den_;
+  }
+  return (*this <=> other) == std::strong_ordering::equal;
+}
+
+std::ostream& operator<<(std::ostream& stream, const BigRational& val) {
+  return stream << val.ToString();
+}
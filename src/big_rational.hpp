@@ -0,0 +1,89 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "big_integer.hpp"
+
+// Exact fraction num / den with den > 0. Canonicalization is lazy: values
+// built from a numerator and denominator are only reduced on first use in
+// rational arithmetic, and arithmetic on reduced operands uses Knuth's
+// cross-GCD formulas (TAOCP 4.5.1), so results come out reduced while the
+// GCDs only see the smaller operands.
+class BigRational {
+ public:
+  BigRational() = default;
+
+  BigRational(BigInt val) : num_(std::move(val)) {}
+
+  template <NativeInt T>
+  BigRational(T val) : num_(val) {}
+
+  // den must not be zero, not reduced until needed
+  BigRational(BigInt num, BigInt den);
+
+  // "num", "num/den" or a decimal "int.frac"
+  static std::optional<BigRational> FromString(std::string_view str);
+
+  // Exact value of a finite double
+  static BigRational FromDouble(double val);
+
+  // "num/den", or just "num" for integers
+  std::string ToString() const;
+
+  // Rounded half away from zero to `digits` fractional digits
+  std::string ToDecimalString(std::size_t digits) const;
+
+  // Nearest double, +-inf on overflow
+  double ToDouble() const;
+
+  // Stored form, call Normalize() first for the canonical one
+  const BigInt& Numerator() const { return num_; }
+  const BigInt& Denominator() const { return den_; }
+
+  bool IsNormalized() const { return normalized_; }
+  void Normalize();
+
+  BigRational& operator+=(const BigRational& other);
+  BigRational& operator-=(const BigRational& other);
+  BigRational& operator*=(const BigRational& other);
+  BigRational& operator/=(const BigRational& other);
+
+  BigRational operator-() const&;
+  BigRational operator-() &&;
+
+  // Decided by sizes alone when magnitudes differ by more than a limb
+  std::strong_ordering operator<=>(const BigRational& other) const;
+  bool operator==(const BigRational& other) const;
+
+ private:
+  BigInt num_;
+  BigInt den_{1};
+  bool normalized_ = true;
+};
+
+static BigRational operator+(BigRational self, const BigRational& other) {
+  self += other;
+  return self;
+}
+
+static BigRational operator-(BigRational self, const BigRational& other) {
+  self -= other;
+  return self;
+}
+
+static BigRational operator*(BigRational self, const BigRational& other) {
+  self *= other;
+  return self;
+}
+
+static BigRational operator/(BigRational self, const BigRational& other) {
+  self /= other;
+  return self;
+}
+
+std::ostream& operator<<(std::ostream& stream, const BigRational& val);
@@ -1,7 +1,28 @@
 #include <gtest/gtest.h>
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <big_float.hpp>
 #include <big_integer.hpp>
+#include <big_integer_accumulator.hpp>
+#include <big_integer_combinatorics.hpp>
+#include <big_integer_file.hpp>
+#include <big_integer_parallel.hpp>
+#include <big_integer_primes.hpp>
+#include <big_integer_random.hpp>
+#include <big_integer_rns.hpp>
+#include <big_rational.hpp>
+#include <big_integer_stats.hpp>
+#include <big_integer_tuning.hpp>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <random>
 #include <sstream>
+#include <thread>
+#include <unordered_set>
 
 TEST(SuiteTest, TestFortyTwo) {
   EXPECT_EQ(7 * 6, 42);
@@ -300,4 +321,1353 @@ TEST(IOTests, Input) {
   in >> a;
 
   EXPECT_EQ(a, "753489479832462184954378953724247348568249832473264754764234"_bi);
-}
\ No newline at end of file
+}
+
+TEST(ConstructionTests, NativeWide) {
+  EXPECT_EQ(BigInt(UINT64_MAX), "18446744073709551615"_bi);
+  EXPECT_EQ(BigInt(INT64_MIN), "-9223372036854775808"_bi);
+  EXPECT_EQ(BigInt(static_cast<UInt128>(UINT64_MAX) * UINT64_MAX),
+            "340282366920938463426481119284349108225"_bi);
+  EXPECT_EQ(BigInt(-static_cast<Int128>(UINT64_MAX) * 4),
+            "-73786976294838206460"_bi);
+  EXPECT_EQ(BigInt(static_cast<Int128>(0)), "0"_bi);
+  EXPECT_EQ(BigInt(static_cast<uint16_t>(7)), "7"_bi);
+}
+
+TEST(ConvertionTests, Int64) {
+  EXPECT_EQ("-9223372036854775808"_bi.ToInt64(), INT64_MIN);
+  EXPECT_EQ("9223372036854775807"_bi.ToInt64(), INT64_MAX);
+  EXPECT_EQ("9223372036854775808"_bi.ToInt64(), std::nullopt);
+  EXPECT_EQ("-9223372036854775809"_bi.ToInt64(), std::nullopt);
+  EXPECT_EQ("0"_bi.ToInt64(), 0);
+
+  EXPECT_EQ("92233720368547758080"_bi.ToInt64Saturating(), INT64_MAX);
+  EXPECT_EQ("-92233720368547758080"_bi.ToInt64Saturating(), INT64_MIN);
+  EXPECT_EQ("-5"_bi.ToInt64Saturating(), -5);
+}
+
+TEST(ConvertionTests, Uint64) {
+  EXPECT_EQ("18446744073709551615"_bi.ToUint64(), UINT64_MAX);
+  EXPECT_EQ("18446744073709551616"_bi.ToUint64(), std::nullopt);
+  EXPECT_EQ("-1"_bi.ToUint64(), std::nullopt);
+
+  EXPECT_EQ("18446744073709551616"_bi.ToUint64Saturating(), UINT64_MAX);
+  EXPECT_EQ("-1"_bi.ToUint64Saturating(), 0U);
+}
+
+TEST(ConvertionTests, Double) {
+  EXPECT_EQ("0"_bi.ToDouble(), 0.0);
+  EXPECT_EQ("-12345"_bi.ToDouble(), -12345.0);
+  EXPECT_EQ("9007199254740993"_bi.ToDouble(), 9007199254740992.0);
+  EXPECT_EQ("340282366920938463463374607431768211456"_bi.ToDouble(),
+            std::ldexp(1.0, 128));
+  // 2^80 + 2^27 + 1 rounds up because of the sticky bit
+  EXPECT_EQ("1208925819614629308923905"_bi.ToDouble(),
+            std::ldexp(1.0, 80) + std::ldexp(1.0, 28));
+
+  BigInt huge = 1;
+  huge.LeftShift(40);  // 2^1280
+  EXPECT_EQ(huge.ToDouble(), std::nullopt);
+  EXPECT_TRUE(std::isinf((-huge).ToDoubleSaturating()));
+  EXPECT_LT((-huge).ToDoubleSaturating(), 0);
+}
+
+TEST(ConvertionTests, FitsIn) {
+  EXPECT_TRUE("127"_bi.FitsIn<int8_t>());
+  EXPECT_FALSE("128"_bi.FitsIn<int8_t>());
+  EXPECT_TRUE("-128"_bi.FitsIn<int8_t>());
+  EXPECT_FALSE("-1"_bi.FitsIn<uint32_t>());
+  EXPECT_TRUE("4294967295"_bi.FitsIn<uint32_t>());
+  EXPECT_FALSE("4294967296"_bi.FitsIn<uint32_t>());
+}
+
+TEST(NativeMathTests, Add) {
+  EXPECT_EQ("18446744073709551615"_bi + UINT64_MAX, "36893488147419103230"_bi);
+  EXPECT_EQ("-18446744073709551615"_bi + UINT64_MAX, "0"_bi);
+  EXPECT_EQ("-18446744073709551616"_bi + UINT64_MAX, "-1"_bi);
+  EXPECT_EQ("5"_bi + INT64_MIN, "-9223372036854775803"_bi);
+  EXPECT_EQ("0"_bi + INT64_MIN, "-9223372036854775808"_bi);
+  EXPECT_EQ("79228162514264337593543950336"_bi + (-1L),
+            "79228162514264337593543950335"_bi);
+  EXPECT_EQ(UINT64_MAX + "1"_bi, "18446744073709551616"_bi);
+}
+
+TEST(NativeMathTests, Sub) {
+  EXPECT_EQ("79228162514264337593543950336"_bi - UINT64_MAX,
+            "79228162495817593519834398721"_bi);
+  EXPECT_EQ("1"_bi - UINT64_MAX, "-18446744073709551614"_bi);
+  EXPECT_EQ("5"_bi - INT64_MIN, "9223372036854775813"_bi);
+  EXPECT_EQ(10 - "3"_bi, "7"_bi);
+  EXPECT_EQ(-10L - "-3"_bi, "-7"_bi);
+}
+
+TEST(NativeMathTests, Mul) {
+  EXPECT_EQ("18446744073709551615"_bi * UINT64_MAX,
+            "340282366920938463426481119284349108225"_bi);
+  EXPECT_EQ("-3"_bi * INT64_MIN, "27670116110564327424"_bi);
+  EXPECT_EQ("3"_bi * 0UL, "0"_bi);
+  EXPECT_EQ(-2L * "3"_bi, "-6"_bi);
+}
+
+TEST(NativeMathTests, DivMod) {
+  auto big = "340282366920938463426481119284349108225"_bi;
+  EXPECT_EQ(big / UINT64_MAX, "18446744073709551615"_bi);
+  EXPECT_EQ(big % UINT64_MAX, "0"_bi);
+  EXPECT_EQ((big + 5) % UINT64_MAX, "5"_bi);
+  EXPECT_EQ("-20"_bi / 6, "-3"_bi);
+  EXPECT_EQ("-20"_bi % 6, "-2"_bi);
+  EXPECT_EQ("20"_bi % (-6), "2"_bi);
+  EXPECT_EQ("20"_bi / (-6L), "-3"_bi);
+  EXPECT_EQ("5"_bi / 6, "0"_bi);
+  EXPECT_EQ(100 / "7"_bi, "14"_bi);
+  EXPECT_EQ(100 % "7"_bi, "2"_bi);
+}
+
+TEST(NativeMathTests, Cmp) {
+  EXPECT_GT("18446744073709551616"_bi, UINT64_MAX);
+  EXPECT_LT("-18446744073709551616"_bi, INT64_MIN);
+  EXPECT_EQ("-9223372036854775808"_bi, INT64_MIN);
+  EXPECT_LT(-1, "0"_bi);
+  EXPECT_GT("0"_bi, -1);
+  EXPECT_LT("-5"_bi, -4);
+  EXPECT_TRUE(5 == "5"_bi);
+}
+
+TEST(MathTests, SubShorterFromLonger) {
+  EXPECT_EQ("3"_bi - "18446744073709551616"_bi, "-18446744073709551613"_bi);
+  EXPECT_EQ("3"_bi + "-18446744073709551616"_bi, "-18446744073709551613"_bi);
+}
+
+TEST(MathTests, DivModLong) {
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+  auto b = "-483828738748356746537483"_bi;
+  BigInt q;
+  BigInt r;
+
+  DivMod(q, r, a, b);
+  EXPECT_EQ(q, "-1557347506437310203365166016944716207"_bi);
+  EXPECT_EQ(r, "141444857623785431677253"_bi);
+
+  DivMod(q, r, -a, b);
+  EXPECT_EQ(q, "1557347506437310203365166016944716207"_bi);
+  EXPECT_EQ(r, "-141444857623785431677253"_bi);
+
+  DivMod(q, r, "79228162514264337593543950336"_bi, "18446744073709551615"_bi);
+  EXPECT_EQ(q, "4294967296"_bi);
+  EXPECT_EQ(r, "4294967296"_bi);
+
+  // Limbs {3, 0, 2^31} / {1, 0, 2^29}: the quotient digit estimate 4
+  // passes the two-limb test and needs the add-back step
+  ResetStats();
+  DivMod(q, r, "39614081257132168796771975171"_bi,
+         "9903520314283042199192993793"_bi);
+  EXPECT_EQ(q, 3);
+  EXPECT_EQ(r, "9903520314283042199192993792"_bi);
+  if constexpr (kBigIntStatsEnabled) {
+    EXPECT_EQ(StatsSnapshot().div_add_backs, 1U);
+  }
+}
+
+TEST(ThreeOperandTests, Aliasing) {
+  auto a = "123456789012345678901234567890"_bi;
+  auto b = "-987654321098765432109876543210"_bi;
+
+  BigInt dst = a;
+  Add(dst, dst, b);
+  EXPECT_EQ(dst, "-864197532086419753208641975320"_bi);
+
+  dst = b;
+  Sub(dst, a, dst);
+  EXPECT_EQ(dst, "1111111110111111111011111111100"_bi);
+
+  dst = a;
+  Mul(dst, dst, dst);
+  EXPECT_EQ(dst, "15241578753238836750495351562536198787501905199875019052100"_bi);
+
+  BigInt q = a;
+  BigInt r = b;
+  DivMod(q, r, q, r);
+  EXPECT_EQ(q, "0"_bi);
+  EXPECT_EQ(r, a);
+
+  q = b;
+  r = a;
+  DivMod(q, r, q, r);
+  EXPECT_EQ(q, "-8"_bi);
+  EXPECT_EQ(r, "-9000000000900000000090"_bi);
+}
+
+TEST(ThreeOperandTests, CapacityReuse) {
+  auto a = "123456789012345678901234567890123456789012345678901234567890"_bi;
+  auto b = "98765432109876543210987654321098765432109876543210"_bi;
+
+  BigInt dst;
+  dst.Reserve(64);
+  std::size_t reserved = dst.Capacity();
+  EXPECT_GE(reserved, 64U);
+
+  Mul(dst, a, b);
+  EXPECT_EQ(dst, a * b);
+  Add(dst, a, b);
+  Sub(dst, dst, a);
+  EXPECT_EQ(dst, b);
+  BigInt rem;
+  DivMod(dst, rem, a, b);
+  EXPECT_EQ(dst, a / b);
+  EXPECT_EQ(dst.Capacity(), reserved);
+
+  // How far shrink_to_fit goes is up to the implementation
+  dst.ShrinkToFit();
+  EXPECT_GE(dst.Capacity(), dst.LimbCount());
+  EXPECT_LE(dst.Capacity(), reserved);
+}
+
+TEST(HashTests, ConsistentWithEq) {
+  std::hash<BigInt> hasher;
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+
+  EXPECT_EQ(hasher(a), hasher(a + 1 - 1));
+  EXPECT_EQ(hasher("0"_bi), hasher("-0"_bi));
+  EXPECT_EQ(hasher("0"_bi), hasher(a - a));
+  EXPECT_NE(hasher(a), hasher(-a));
+  EXPECT_NE(hasher(a), hasher(a + 1));
+  EXPECT_NE(hasher("1"_bi), hasher("4294967296"_bi));
+}
+
+TEST(HashTests, UnorderedSet) {
+  std::unordered_set<BigInt> set;
+  BigInt val = "1"_bi;
+
+  for (int i = 0; i < 200; ++i) {
+    set.insert(val);
+    val *= 3;
+  }
+
+  EXPECT_EQ(set.size(), 200U);
+  EXPECT_TRUE(set.contains("3"_bi * 3 * 3));
+  EXPECT_FALSE(set.contains("2"_bi));
+}
+
+TEST(HashTests, CachedHash) {
+  std::unordered_set<HashedBigInt> set;
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+
+  set.emplace(a);
+  set.emplace(-a);
+  set.emplace(a * a);
+
+  EXPECT_EQ(set.size(), 3U);
+  EXPECT_TRUE(set.contains(HashedBigInt(a)));
+  EXPECT_EQ(HashedBigInt(a).Hash(), std::hash<BigInt>{}(a));
+}
+
+TEST(RadixTests, ToStringPowerOfTwo) {
+  auto a = "340282366920938463463374607431768211455"_bi;  // 2^128 - 1
+  EXPECT_EQ(a.ToString(16), std::string(32, 'f'));
+  EXPECT_EQ(a.ToString(2), std::string(128, '1'));
+  EXPECT_EQ((a + 1).ToString(8), "4" + std::string(42, '0'));
+  EXPECT_EQ("-3735928559"_bi.ToString(16), "-deadbeef");
+  EXPECT_EQ("1267650600228229401496703205376"_bi.ToString(32),
+            "1" + std::string(20, '0'));
+  EXPECT_EQ("0"_bi.ToString(2), "0");
+}
+
+TEST(RadixTests, ToStringOther) {
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+  EXPECT_EQ(a.ToString(), "753489479832462184954378953724247348568249832473264754764234");
+  EXPECT_EQ("-1000000000"_bi.ToString(10), "-1000000000");
+  EXPECT_EQ("35"_bi.ToString(36), "z");
+  EXPECT_EQ("1295"_bi.ToString(36), "zz");
+  EXPECT_EQ("-49"_bi.ToString(7), "-100");
+  EXPECT_EQ("4294967296"_bi.ToString(3), "102002022201221111211");
+}
+
+TEST(RadixTests, FromString) {
+  EXPECT_EQ(BigInt::FromString("ffffffffffffffffffffffffffffffff", 16),
+            "340282366920938463463374607431768211455"_bi);
+  EXPECT_EQ(BigInt::FromString("-DeadBeef", 16), "-3735928559"_bi);
+  EXPECT_EQ(BigInt::FromString("+zz", 36), "1295"_bi);
+  EXPECT_EQ(BigInt::FromString("102002022201221111211", 3), "4294967296"_bi);
+  EXPECT_EQ(BigInt::FromString("-0000", 2), "0"_bi);
+  EXPECT_EQ(BigInt::FromString("777", 8), "511"_bi);
+
+  EXPECT_EQ(BigInt::FromString("", 10), std::nullopt);
+  EXPECT_EQ(BigInt::FromString("-", 10), std::nullopt);
+  EXPECT_EQ(BigInt::FromString("12a", 10), std::nullopt);
+  EXPECT_EQ(BigInt::FromString("102", 2), std::nullopt);
+  EXPECT_EQ(BigInt::FromString("g", 16), std::nullopt);
+}
+
+TEST(RadixTests, RoundTrip) {
+  BigInt val = "-1"_bi;
+  for (int i = 0; i < 40; ++i) {
+    val *= "98765432109876543210"_bi;
+    val += i;
+  }
+
+  for (int radix = 2; radix <= 36; ++radix) {
+    EXPECT_EQ(BigInt::FromString(val.ToString(radix), radix), val) << radix;
+  }
+}
+
+TEST(RadixTests, DivideAndConquer) {
+  BigIntThresholds saved = GetThresholds();
+  BigIntThresholds thresholds = saved;
+  std::mt19937_64 rng(29);
+
+  // Zero runs across the split points and exact powers of the radix
+  std::vector<BigInt> values = {RandomBits(9000, rng),
+                               RandomBits(2000, rng) << 3000};
+  for (int radix : {3, 10, 36}) {
+    BigInt power = 1;
+    for (int i = 0; i < 700; ++i) {
+      power *= radix;
+    }
+    values.insert(values.end(), {power, power - 1, power + 1});
+  }
+
+  for (int radix : {3, 7, 10, 36}) {
+    for (const BigInt& val : values) {
+      thresholds.radix_conversion = SIZE_MAX;
+      SetThresholds(thresholds);
+      std::string plain = val.ToString(radix);
+
+      thresholds.radix_conversion = 2;
+      SetThresholds(thresholds);
+      EXPECT_EQ(val.ToString(radix), plain) << radix;
+      EXPECT_EQ(BigInt::FromString(plain, radix), val) << radix;
+      EXPECT_EQ(BigInt::FromString("-000" + plain, radix), -val) << radix;
+    }
+  }
+
+  thresholds.radix_conversion = 2;
+  SetThresholds(thresholds);
+  EXPECT_EQ(BigInt::FromString(std::string(500, '0'), 10), 0);
+  EXPECT_EQ(BigInt::FromString(std::string(500, '1') + "a", 10),
+            std::nullopt);
+
+  SetThresholds(saved);
+}
+
+TEST(IOTests, OutputHex) {
+  std::stringstream out;
+  out << std::hex << "-3735928559"_bi << ' ' << std::oct << "511"_bi;
+  EXPECT_EQ(out.str(), "-deadbeef 777");
+}
+
+#ifdef __cpp_lib_format
+TEST(IOTests, Format) {
+  EXPECT_EQ(std::format("{}", "-3735928559"_bi), "-3735928559");
+  EXPECT_EQ(std::format("{:x}", "3735928559"_bi), "deadbeef");
+  EXPECT_EQ(std::format("{:#X}", "-3735928559"_bi), "-0XDEADBEEF");
+  EXPECT_EQ(std::format("{:#b}", "5"_bi), "0b101");
+  EXPECT_EQ(std::format("{:#o}", "0"_bi), "0");
+  EXPECT_EQ(std::format("{:#d}", "5"_bi), "5");
+  EXPECT_EQ(std::format("{:#}", "-5"_bi), "-5");
+  EXPECT_EQ(std::format("{:#06}", "-5"_bi), "-00005");
+}
+
+TEST(IOTests, FormatPadding) {
+  EXPECT_EQ(std::format("{:8}", "-42"_bi), "     -42");
+  EXPECT_EQ(std::format("{:<6}|", "42"_bi), "42    |");
+  EXPECT_EQ(std::format("{:*^7x}", "255"_bi), "**ff***");
+  EXPECT_EQ(std::format("{:_>#8b}", "5"_bi), "___0b101");
+  EXPECT_EQ(std::format("{:06}", "-42"_bi), "-00042");
+  EXPECT_EQ(std::format("{:#010x}", "255"_bi), "0x000000ff");
+  EXPECT_EQ(std::format("{:<06}|", "42"_bi), "42    |");
+  EXPECT_EQ(std::format("{:2}", "-12345"_bi), "-12345");
+}
+#endif
+
+TEST(IOTests, InputMultiple) {
+  std::stringstream in("  -42\n+17 0000 18446744073709551616");
+  BigInt a;
+  BigInt b;
+  BigInt c;
+  BigInt d;
+
+  in >> a >> b >> c >> d;
+  EXPECT_EQ(a, "-42"_bi);
+  EXPECT_EQ(b, "17"_bi);
+  EXPECT_EQ(c, "0"_bi);
+  EXPECT_EQ(d, "18446744073709551616"_bi);
+  EXPECT_TRUE(in.eof());
+  EXPECT_FALSE(in.fail());
+}
+
+TEST(IOTests, InputRadix) {
+  std::stringstream in("-DEADbeef 777 ffffffffffffffffffffffffffffffffff");
+  BigInt a;
+  BigInt b;
+  BigInt c;
+
+  in >> std::hex >> a >> std::oct >> b >> std::hex >> c;
+  EXPECT_EQ(a, "-3735928559"_bi);
+  EXPECT_EQ(b, "511"_bi);
+  EXPECT_EQ(c, "87112285931760246646623899502532662132735"_bi);
+
+  std::stringstream bin("101010101010101010101010101010101");
+  ReadBigInt(bin, a, 2);
+  EXPECT_EQ(a, "5726623061"_bi);
+
+  std::stringstream base36("Zz");
+  ReadBigInt(base36, a, 36);
+  EXPECT_EQ(a, "1295"_bi);
+}
+
+TEST(IOTests, InputMalformed) {
+  BigInt a = 5;
+
+  std::stringstream garbage("12a3");
+  garbage >> a;
+  EXPECT_TRUE(garbage.fail());
+  EXPECT_EQ(a, "0"_bi);
+
+  std::stringstream sign_only("- 5");
+  sign_only >> a;
+  EXPECT_TRUE(sign_only.fail());
+
+  std::stringstream empty("   ");
+  empty >> a;
+  EXPECT_TRUE(empty.fail());
+}
+
+TEST(IOTests, InputRoundTripHuge) {
+  BigInt val = "-7"_bi;
+  for (int i = 0; i < 300; ++i) {
+    val *= "98765432109876543210"_bi;
+  }
+
+  for (int radix : {8, 10, 16}) {
+    std::stringstream io;
+    io << std::setbase(radix) << val;
+
+    BigInt parsed;
+    io >> std::setbase(radix) >> parsed;
+    EXPECT_EQ(parsed, val) << radix;
+  }
+}
+
+TEST(TuningTests, LoadSave) {
+  BigIntThresholds saved = GetThresholds();
+
+  std::stringstream config("# tuned\nkaratsuba_mul = 10\n\nkaratsuba_sqr=12\n");
+  EXPECT_TRUE(LoadThresholds(config));
+  EXPECT_EQ(GetThresholds().karatsuba_mul, 10U);
+  EXPECT_EQ(GetThresholds().karatsuba_sqr, 12U);
+
+  std::stringstream bad("karatsuba_mul = 20\nunknown = 3\n");
+  EXPECT_FALSE(LoadThresholds(bad));
+  EXPECT_EQ(GetThresholds().karatsuba_mul, 10U);
+
+  std::stringstream out;
+  SaveThresholds(out, GetThresholds());
+  EXPECT_EQ(out.str(),
+            "karatsuba_mul = 10\nkaratsuba_sqr = 12\nradix_conversion = " +
+                std::to_string(saved.radix_conversion) + "\nnewton_div = " +
+                std::to_string(saved.newton_div) + "\n");
+
+  std::stringstream tiers("radix_conversion = 7\nnewton_div = 9\n");
+  EXPECT_TRUE(LoadThresholds(tiers));
+  EXPECT_EQ(GetThresholds().radix_conversion, 7U);
+  EXPECT_EQ(GetThresholds().newton_div, 9U);
+
+  if (std::getenv("BIGINT_TUNE_CONFIG") == nullptr) {
+    EXPECT_EQ(EnvConfigStatus(), TuneConfigStatus::NotSet);
+  }
+
+  SetThresholds(saved);
+}
+
+TEST(TuningTests, TiersAgree) {
+  BigIntThresholds saved = GetThresholds();
+
+  BigInt lhs = "-1"_bi;
+  BigInt rhs = "1"_bi;
+  for (int i = 0; i < 120; ++i) {
+    lhs = lhs * "98765432109876543210"_bi + i;
+    rhs = rhs * "12345678901234567890123"_bi - i;
+  }
+  BigInt short_rhs = rhs / "340282366920938463463374607431768211456"_bi;
+
+  BigInt num = lhs * lhs * rhs;
+
+  SetThresholds({SIZE_MAX, SIZE_MAX, SIZE_MAX, SIZE_MAX});
+  BigInt school = lhs * rhs;
+  BigInt school_short = lhs * short_rhs;
+  BigInt school_sqr = lhs * lhs;
+  BigInt knuth_quot = num / rhs;
+  BigInt knuth_rem = num % rhs;
+  BigInt knuth_short = num / -short_rhs;
+
+  SetThresholds({4, 4, 4, 4});
+  EXPECT_EQ(lhs * rhs, school);
+  EXPECT_EQ(lhs * short_rhs, school_short);
+  EXPECT_EQ(lhs * lhs, school_sqr);
+  EXPECT_EQ(num / rhs, knuth_quot);
+  EXPECT_EQ(num % rhs, knuth_rem);
+  EXPECT_EQ(num / -short_rhs, knuth_short);
+  EXPECT_EQ((rhs * rhs - 1) / rhs, rhs - 1);
+  EXPECT_EQ((rhs * rhs - 1) % rhs, rhs - 1);
+
+  SetThresholds(saved);
+}
+
+TEST(StatsTests, Counters) {
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+  auto b = "483828738748356746537483"_bi;
+
+  ResetStats();
+  BigInt q;
+  BigInt r;
+  DivMod(q, r, a, b);
+  Mul(q, a, b);
+  Mul(r, a, a);
+  r += 5;
+  BigIntStats stats = StatsSnapshot();
+
+  if constexpr (kBigIntStatsEnabled) {
+    auto op = [&](BigIntOp id) { return stats.ops[static_cast<int>(id)]; };
+    EXPECT_EQ(op(BigIntOp::DivMod).calls, 1U);
+    EXPECT_EQ(op(BigIntOp::DivMod).limbs_log2[3], 1U);  // 7 limbs
+    EXPECT_EQ(op(BigIntOp::Mul).calls, 1U);
+    EXPECT_EQ(op(BigIntOp::Sqr).calls, 1U);
+    EXPECT_EQ(op(BigIntOp::NativeAdd).calls, 1U);
+    EXPECT_EQ(stats.div_steps, 5U);
+    EXPECT_GT(stats.allocations, 0U);
+    EXPECT_GT(stats.allocated_bytes, 0U);
+  } else {
+    EXPECT_EQ(stats.ops[0].calls, 0U);
+    EXPECT_EQ(stats.allocations, 0U);
+  }
+}
+
+TEST(StatsTests, Export) {
+  BigIntStats stats;
+  stats.ops[static_cast<int>(BigIntOp::Mul)].calls = 3;
+  stats.ops[static_cast<int>(BigIntOp::Mul)].limbs_total = 9;
+  stats.ops[static_cast<int>(BigIntOp::Mul)].limbs_log2[2] = 3;
+  stats.div_steps = 7;
+
+  std::stringstream json;
+  WriteStatsJson(json, stats);
+  EXPECT_NE(json.str().find("\"mul\":{\"calls\":3,\"limbs_total\":9,"
+                            "\"limbs_log2\":[0,0,3,0"),
+            std::string::npos);
+  EXPECT_NE(json.str().find("\"div_steps\":7"), std::string::npos);
+
+  std::stringstream prom;
+  WriteStatsPrometheus(prom, stats);
+  EXPECT_NE(prom.str().find("bigint_op_limbs_bucket{op=\"mul\",le=\"1\"} 0\n"
+                            "bigint_op_limbs_bucket{op=\"mul\",le=\"3\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(prom.str().find("bigint_op_limbs_count{op=\"mul\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(prom.str().find("bigint_div_steps_total 7\n"), std::string::npos);
+}
+
+TEST(SharedTests, NegateTemporary) {
+  auto a = "753489479832462184954378953724247348568249832473264754764234"_bi;
+  EXPECT_EQ(-(a * 2), "-1506978959664924369908757907448494697136499664946529509528468"_bi);
+  EXPECT_EQ(-BigInt(0), "0"_bi);
+  EXPECT_EQ(5 - a, -(a - 5));
+}
+
+TEST(SharedTests, ConstHandle) {
+  BigIntConst modulus =
+      "753489479832462184954378953724247348568249832473264754764234"_bi;
+  BigIntConst copy = modulus;
+
+  EXPECT_EQ(&copy.Get(), &modulus.Get());
+  EXPECT_EQ(copy, modulus);
+  EXPECT_EQ(BigIntConst(), BigIntConst("0"_bi));
+  EXPECT_EQ(&BigIntConst().Get(), &BigIntConst().Get());
+
+  BigInt val = "1000000000000000000000000000"_bi;
+  EXPECT_EQ(val * modulus % modulus, "0"_bi);
+  EXPECT_LT(val, modulus);
+  EXPECT_EQ(modulus->ToString(16), modulus.Get().ToString(16));
+
+  BigInt mutated = modulus.ToMutable();
+  mutated += 1;
+  EXPECT_NE(mutated, *modulus);
+  EXPECT_EQ(std::hash<BigIntConst>{}(copy), std::hash<BigInt>{}(*modulus));
+}
+
+TEST(SharedTests, ConcurrentReaders) {
+  BigIntConst shared = "98765432109876543210987654321098765432109876543210"_bi;
+  BigInt expected = shared.Get() * shared.Get();
+  std::vector<std::thread> threads;
+  std::atomic<int> matches = 0;
+
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([shared, &expected, &matches] {
+      for (int j = 0; j < 100; ++j) {
+        BigIntConst local = shared;
+        if (local.Get() * local.Get() == expected) {
+          ++matches;
+        }
+      }
+    });
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(matches, 400);
+}
+
+TEST(AccumulatorTests, SignedSum) {
+  BigIntAccumulator acc;
+  BigInt expected;
+  BigInt val = "123456789012345678901234567890"_bi;
+
+  for (int i = 0; i < 1000; ++i) {
+    acc += val;
+    expected += val;
+    if (i % 3 == 0) {
+      acc -= val * i;
+      expected -= val * i;
+    }
+    acc += -i;
+    expected += -i;
+    acc -= UINT64_MAX;
+    expected -= UINT64_MAX;
+  }
+
+  EXPECT_EQ(acc.Result(), expected);
+  acc += 1;
+  EXPECT_EQ(acc.Result(), expected + 1);
+
+  acc.Clear();
+  EXPECT_EQ(acc.Result(), 0);
+}
+
+TEST(AccumulatorTests, Products) {
+  BigIntAccumulator acc;
+  BigInt expected;
+  BigInt small = "-98765432109876543210987654321"_bi;
+  BigInt large = BigInt(3);
+  for (int i = 0; i < 9; ++i) {
+    large = large * large + 7;
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    acc.AddProduct(small, small + i);
+    expected += small * (small + i);
+    acc.AddProduct(large, small - i);
+    expected += large * (small - i);
+    acc.AddProduct(large, large);
+    expected += large * large;
+  }
+  acc.AddProduct(large, 0);
+
+  EXPECT_EQ(acc.Result(), expected);
+}
+
+TEST(AccumulatorTests, MergeThreads) {
+  constexpr int kThreads = 4;
+  std::vector<BigIntAccumulator> partial(kThreads);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&partial, t] {
+      for (int64_t i = 0; i < 10000; ++i) {
+        partial[t] += BigInt(i * kThreads + t) * INT64_MAX;
+        partial[t] -= i;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BigIntAccumulator total;
+  for (auto& acc : partial) {
+    total.Merge(std::move(acc));
+  }
+
+  int64_t n = 10000 * kThreads;
+  BigInt expected = BigInt(n * (n - 1) / 2) * INT64_MAX -
+                    BigInt(int64_t{10000} * 9999 / 2 * kThreads);
+  EXPECT_EQ(total.Result(), expected);
+}
+
+TEST(CombinatoricsTests, Product) {
+  std::vector<BigInt> values;
+  BigInt expected = 1;
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(BigInt(i % 7 == 0 ? -i - 1 : i + 1) * INT64_MAX);
+    expected *= values.back();
+  }
+
+  EXPECT_EQ(Product(values), expected);
+  EXPECT_EQ(Product({}), 1);
+  EXPECT_EQ(ProductRange(5, 4), 1);
+  EXPECT_EQ(ProductRange(0, 10), 0);
+  EXPECT_EQ(ProductRange(UINT64_MAX, UINT64_MAX), UINT64_MAX);
+
+  expected = 1;
+  for (uint64_t i = 1000000; i <= 1003000; ++i) {
+    expected *= i;
+  }
+  EXPECT_EQ(ProductRange(1000000, 1003000), expected);
+}
+
+TEST(CombinatoricsTests, Factorial) {
+  EXPECT_EQ(Factorial(0), 1);
+  EXPECT_EQ(Factorial(20), 2432902008176640000u);
+  EXPECT_EQ(Factorial(50),
+            "3041409320171337804361260816606476884437764156896051200000000"
+            "0000"_bi);
+
+  BigInt expected = 1;
+  for (int i = 2; i <= 3000; ++i) {
+    expected *= i;
+    if (i % 499 == 0) {
+      EXPECT_EQ(Factorial(i), expected);
+    }
+  }
+  EXPECT_EQ(Factorial(3000), expected);
+}
+
+TEST(CombinatoricsTests, Binomial) {
+  EXPECT_EQ(Binomial(5, 7), 0);
+  EXPECT_EQ(Binomial(7, 0), 1);
+  EXPECT_EQ(Binomial(52, 5), 2598960);
+  EXPECT_EQ(Binomial(100, 50), "100891344545564193334812497256"_bi);
+  EXPECT_EQ(Binomial(2000, 1000), Factorial(2000) / Factorial(1000) /
+                                      Factorial(1000));
+  EXPECT_EQ(Binomial(uint64_t{1} << 40, 2),
+            "604462909806764831539200"_bi);
+}
+
+TEST(CombinatoricsTests, Primorial) {
+  EXPECT_EQ(Primorial(1), 1);
+  EXPECT_EQ(Primorial(30), 6469693230);
+  EXPECT_EQ(Primorial(100),
+            "2305567963945518424753102147331756070"_bi);
+}
+
+TEST(PrimeTests, MontgomeryPow) {
+  BigInt mod = "170141183460469231731687303715884105727"_bi;
+  MontgomeryContext ctx(mod);
+  BigInt base = "-12345678901234567890123"_bi;
+
+  BigInt expected = 1;
+  for (int exp = 0; exp < 300; ++exp) {
+    EXPECT_EQ(ctx.Pow(base, exp), expected);
+    expected = expected * base % mod;
+    if (expected < 0) {
+      expected += mod;
+    }
+  }
+
+  // Fermat
+  EXPECT_EQ(ctx.Pow(base, mod - 1), 1);
+  EXPECT_EQ(MontgomeryContext(BigInt(15)).Pow(7, 3), 13);
+}
+
+TEST(PrimeTests, IsProbablePrime) {
+  int small_count = 0;
+  for (int i = -10; i < 10000; ++i) {
+    small_count += IsProbablePrime(i);
+  }
+  EXPECT_EQ(small_count, 1229);
+
+  EXPECT_TRUE(IsProbablePrime(1000003));
+  EXPECT_TRUE(IsProbablePrime(BigInt(UINT64_MAX) - 58));
+  EXPECT_TRUE(IsProbablePrime("170141183460469231731687303715884105727"_bi));
+  EXPECT_TRUE(IsProbablePrime("100000000000000000039"_bi, 10));
+
+  // Carmichael numbers and strong pseudoprimes to many bases
+  EXPECT_FALSE(IsProbablePrime(41041));
+  EXPECT_FALSE(IsProbablePrime(3215031751));
+  EXPECT_FALSE(IsProbablePrime(3825123056546413051));
+  EXPECT_FALSE(IsProbablePrime("318665857834031151167461"_bi));
+
+  // Squares have no Selfridge D
+  BigInt mersenne = "2305843009213693951"_bi;
+  EXPECT_FALSE(IsProbablePrime(mersenne * mersenne));
+}
+
+TEST(PrimeTests, NextPrime) {
+  EXPECT_EQ(NextPrime(-5), 2);
+  EXPECT_EQ(NextPrime(2), 3);
+  EXPECT_EQ(NextPrime(1021), 1031);
+  EXPECT_EQ(NextPrime("100000000000000000000"_bi),
+            "100000000000000000039"_bi);
+
+  BigInt pow2 = 1;
+  pow2.LeftShift(4);
+  EXPECT_EQ(NextPrime(pow2 / 2),
+            "170141183460469231731687303715884105757"_bi);
+}
+
+TEST(PrimeTests, NextPrimesParallel) {
+  BigInt start = "1000000000000000000000000000000"_bi;
+  std::vector<BigInt> expected = {
+      "1000000000000000000000000000057"_bi,
+      "1000000000000000000000000000099"_bi,
+      "1000000000000000000000000000211"_bi,
+      "1000000000000000000000000000231"_bi,
+      "1000000000000000000000000000271"_bi};
+
+  EXPECT_EQ(NextPrimes(start, 5, 1), expected);
+  EXPECT_EQ(NextPrimes(start, 5, 4), expected);
+
+  std::vector<BigInt> small = NextPrimes(1000, 300, 3);
+  ASSERT_EQ(small.size(), 300);
+  EXPECT_EQ(small.front(), 1009);
+  for (std::size_t i = 1; i < small.size(); ++i) {
+    EXPECT_EQ(small[i], NextPrime(small[i - 1]));
+  }
+}
+
+TEST(RnsTests, RoundTrip) {
+  auto basis = RnsBasis::ForBits(1000);
+  BigInt bound = 1;
+  bound.LeftShift(1000 / 32);
+  EXPECT_GT(basis->Modulus(), bound);
+  EXPECT_EQ(basis->Size(), (1000 + 2 + 29) / 30);
+
+  BigInt val = "-123456789012345678901234567890123456789"_bi;
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(RnsInt(basis, val).ToBigInt(), val);
+    EXPECT_EQ(RnsInt(basis, -val).ToBigInt(), -val);
+    val = val * 1000003 + i;
+  }
+
+  EXPECT_EQ(RnsInt(basis).ToBigInt(), 0);
+  EXPECT_EQ(RnsInt(basis, 1).ToBigInt(), 1);
+  EXPECT_EQ(RnsInt(basis, -1).ToBigInt(), -1);
+}
+
+TEST(RnsTests, Arithmetic) {
+  auto basis = RnsBasis::ForBits(2000);
+  BigInt a = "98765432109876543210987654321098765432109876543210"_bi;
+  BigInt b = "-1234567890123456789012345678901234567890"_bi;
+  BigInt c = "31415926535897932384626433832795028841971"_bi;
+
+  RnsInt ra(basis, a);
+  RnsInt rb(basis, b);
+  RnsInt rc(basis, c);
+
+  RnsInt res = ra * rb - rc * rc + ra;
+  EXPECT_EQ(res.ToBigInt(), a * b - c * c + a);
+  EXPECT_EQ((-res).ToBigInt(), -(a * b - c * c + a));
+  EXPECT_EQ(ra * rb, RnsInt(basis, a * b));
+
+  // Residues wrap around the modulus but stay consistent
+  RnsInt acc(basis, 1);
+  BigInt expected = 1;
+  for (int i = 0; i < 10; ++i) {
+    acc *= rc;
+    expected *= c;
+  }
+  EXPECT_EQ(acc, RnsInt(basis, expected % basis->Modulus()));
+}
+
+TEST(RnsTests, LargeBasis) {
+  auto basis = RnsBasis::ForBits(30 * 2000);
+  BigInt val = 1;
+  val.LeftShift(400);
+  val = val * val - 12345;
+
+  RnsInt rval(basis, val);
+  EXPECT_EQ((rval * rval).ToBigInt(), val * val);
+  EXPECT_EQ((rval + rval - rval).ToBigInt(), val);
+}
+
+TEST(RnsTests, FromPrimes) {
+  auto basis = RnsBasis::FromPrimes({65537, 2147483647, 7});
+  ASSERT_NE(basis, nullptr);
+  EXPECT_EQ(basis->Modulus(), BigInt(65537) * 2147483647 * 7);
+  EXPECT_EQ(RnsInt(basis, -123456789).ToBigInt(), -123456789);
+
+  EXPECT_EQ(RnsBasis::FromPrimes({}), nullptr);
+  EXPECT_EQ(RnsBasis::FromPrimes({7, 65537, 7}), nullptr);
+  EXPECT_EQ(RnsBasis::FromPrimes({7, 65535}), nullptr);
+  EXPECT_EQ(RnsBasis::FromPrimes({1}), nullptr);
+  EXPECT_EQ(RnsBasis::FromPrimes({4294967291U}), nullptr);
+}
+
+TEST(ParallelTests, ParallelFor) {
+  std::vector<std::atomic<int>> calls(1000);
+  ParallelFor(calls.size(), [&](std::size_t i) { ++calls[i]; });
+  for (const auto& count : calls) {
+    EXPECT_EQ(count, 1);
+  }
+
+  // Nested and concurrent callers share the pool
+  std::atomic<int> total = 0;
+  std::vector<std::thread> callers;
+  for (int t = 0; t < 4; ++t) {
+    callers.emplace_back([&] {
+      ParallelFor(8, [&](std::size_t) {
+        ParallelFor(16, [&](std::size_t) { ++total; });
+      });
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(total, 4 * 8 * 16);
+  EXPECT_GE(ParallelThreads(), 1U);
+}
+
+TEST(MathTests, Gcd) {
+  EXPECT_EQ(Gcd(0, 0), 0);
+  EXPECT_EQ(Gcd(0, -7), 7);
+  EXPECT_EQ(Gcd(-12, 18), 6);
+
+  BigInt prime = "170141183460469231731687303715884105727"_bi;
+  BigInt a = prime * "12345678901234567890"_bi * 6;
+  BigInt b = prime * "98765432109876543210"_bi * -4;
+  EXPECT_EQ(Gcd(a, b), prime * 1800000000180);
+  EXPECT_EQ(Gcd(a, prime + 2), 3);
+}
+
+TEST(MathTests, Shifts) {
+  EXPECT_EQ(BigInt(0).BitLength(), 0);
+  EXPECT_EQ(BigInt(-5).BitLength(), 3);
+  EXPECT_EQ((BigInt(1) << 100).BitLength(), 101);
+
+  EXPECT_EQ(BigInt(3) << 65, "110680464442257309696"_bi);
+  EXPECT_EQ(BigInt(-3) << 0, -3);
+  EXPECT_EQ("110680464442257309696"_bi >> 65, 3);
+  EXPECT_EQ("110680464442257309697"_bi >> 64, 6);
+
+  // Floor, like the division by a power of two rounded down
+  EXPECT_EQ(BigInt(-7) >> 1, -4);
+  EXPECT_EQ(BigInt(-8) >> 2, -2);
+  EXPECT_EQ(BigInt(-1) >> 100, -1);
+  EXPECT_EQ(BigInt(7) >> 100, 0);
+  EXPECT_EQ(-"110680464442257309697"_bi >> 64, -7);
+}
+
+TEST(MathTests, Bits) {
+  BigInt val;
+  EXPECT_FALSE(val.TestBit(0));
+  val.SetBit(100);
+  EXPECT_EQ(val, BigInt(1) << 100);
+  EXPECT_EQ(val.LimbCount(), 4);
+  EXPECT_TRUE(val.TestBit(100));
+  EXPECT_FALSE(val.TestBit(99));
+  EXPECT_FALSE(val.TestBit(1000));
+
+  val.SetBit(3);
+  EXPECT_EQ(val.CountTrailingZeros(), 3);
+  EXPECT_EQ(val.PopCount(), 2);
+  val.ClearBit(100);
+  EXPECT_EQ(val, 8);
+  EXPECT_EQ(val.LimbCount(), 1);
+  val.ClearBit(5000);
+  val.ClearBit(3);
+  EXPECT_EQ(val, 0);
+  EXPECT_EQ(val.LimbCount(), 0);
+
+  // Magnitude bits, the sign stays
+  BigInt neg = -"340282366920938463463374607431768211455"_bi;
+  EXPECT_EQ(neg.PopCount(), 128);
+  EXPECT_EQ(neg.CountTrailingZeros(), 0);
+  neg.ClearBit(0);
+  EXPECT_EQ(neg, -"340282366920938463463374607431768211454"_bi);
+  EXPECT_EQ((BigInt(-3) << 70).CountTrailingZeros(), 70);
+  EXPECT_EQ(BigInt(0).CountTrailingZeros(), 0);
+  EXPECT_EQ(BigInt(0).PopCount(), 0);
+
+  // Odd limb counts and sizes around the 16-limb vector blocks
+  std::mt19937_64 rng(41);
+  for (uint64_t bits : {33, 95, 511, 512, 513, 1000, 4131}) {
+    BigInt val = RandomBits(bits - 1, rng) + (BigInt(1) << (bits - 1));
+    uint64_t ones = 0;
+    for (uint64_t bit = 0; bit < bits; ++bit) {
+      ones += val.TestBit(bit) ? 1 : 0;
+    }
+    EXPECT_EQ(val.PopCount(), ones) << bits;
+  }
+
+  EXPECT_EQ(BigInt(1024).Log2Approx(), 10.0);
+  EXPECT_NEAR((BigInt(3) << 1000).Log2Approx(), 1000 + std::log2(3.0),
+              1e-9);
+  EXPECT_NEAR(Factorial(1000).Log2Approx(),
+              std::lgamma(1001.0) / std::log(2.0), 1e-6);
+  EXPECT_EQ(BigInt(0).Log2Approx(), -INFINITY);
+}
+
+TEST(RationalTests, Construction) {
+  BigRational half(3, -6);
+  EXPECT_FALSE(half.IsNormalized());
+  EXPECT_EQ(half.Denominator(), 6);
+  EXPECT_EQ(half, BigRational(-1, 2));
+
+  half.Normalize();
+  EXPECT_EQ(half.Numerator(), -1);
+  EXPECT_EQ(half.Denominator(), 2);
+  EXPECT_EQ(half.ToString(), "-1/2");
+  EXPECT_EQ(BigRational(0, 5).ToString(), "0/5");
+  EXPECT_EQ(BigRational(0, 5) + 0, 0);
+
+  EXPECT_EQ(BigRational::FromString("-10/4")->ToString(), "-5/2");
+  EXPECT_EQ(BigRational::FromString("-0.125")->ToString(), "-1/8");
+  EXPECT_EQ(BigRational::FromString("12.50")->ToString(), "25/2");
+  EXPECT_EQ(BigRational::FromString("42")->ToString(), "42");
+  EXPECT_FALSE(BigRational::FromString("1/0"));
+  EXPECT_FALSE(BigRational::FromString("1."));
+  EXPECT_FALSE(BigRational::FromString("-.5"));
+  EXPECT_FALSE(BigRational::FromString("1.-5"));
+  EXPECT_FALSE(BigRational::FromString("a/2"));
+}
+
+TEST(RationalTests, Arithmetic) {
+  BigRational sum;
+  for (int i = 1; i <= 30; ++i) {
+    sum += BigRational(1, i);
+  }
+  EXPECT_TRUE(sum.IsNormalized());
+  EXPECT_EQ(sum.ToString(), "9304682830147/2329089562800");
+
+  BigRational x(-7, 15);
+  BigRational y(10, 21);
+  EXPECT_EQ((x * y).ToString(), "-2/9");
+  EXPECT_EQ((x / y).ToString(), "-49/50");
+  EXPECT_EQ((x - y).ToString(), "-33/35");
+  EXPECT_EQ((x + y).ToString(), "1/105");
+  EXPECT_EQ((x + 1).ToString(), "8/15");
+  EXPECT_EQ((-x).ToString(), "7/15");
+
+  BigRational self(6, 4);
+  self *= self;
+  EXPECT_EQ(self.ToString(), "9/4");
+  self += self;
+  EXPECT_EQ(self.ToString(), "9/2");
+  self /= self;
+  EXPECT_EQ(self.ToString(), "1");
+  self -= self;
+  EXPECT_EQ(self.ToString(), "0");
+  EXPECT_EQ((x * 0).Denominator(), 1);
+}
+
+TEST(RationalTests, Comparison) {
+  BigRational small(1, "1000000000000000000000000000000"_bi);
+  BigRational large("1000000000000000000000000000000"_bi, 3);
+
+  EXPECT_LT(small, large);
+  EXPECT_GT(-small, -large);
+  EXPECT_LT(-large, small);
+  EXPECT_LT(BigRational(1, 3), BigRational(1, 2));
+  EXPECT_LT(BigRational(-1, 2), BigRational(-1, 3));
+  EXPECT_EQ(BigRational(2, 6) <=> BigRational(1, 3),
+            std::strong_ordering::equal);
+  EXPECT_GT(BigRational(1, 3), 0);
+  EXPECT_EQ(BigRational(8, 4), 2);
+}
+
+TEST(RationalTests, Conversion) {
+  EXPECT_EQ(BigRational(1, 3).ToDecimalString(5), "0.33333");
+  EXPECT_EQ(BigRational(2, 3).ToDecimalString(5), "0.66667");
+  EXPECT_EQ(BigRational(-1, 8).ToDecimalString(2), "-0.13");
+  EXPECT_EQ(BigRational(-1, 1000).ToDecimalString(2), "0.00");
+  EXPECT_EQ(BigRational(22, 7).ToDecimalString(0), "3");
+  EXPECT_EQ(BigRational(-1234, 10).ToDecimalString(3), "-123.400");
+
+  EXPECT_EQ(BigRational(1, 3).ToDouble(), 1.0 / 3);
+  EXPECT_EQ(BigRational(-2, 7).ToDouble(), -2.0 / 7);
+  EXPECT_EQ(BigRational(0).ToDouble(), 0.0);
+  EXPECT_EQ(BigRational("1000000000000000000000000000000"_bi, 3).ToDouble(),
+            1e30 / 3);
+
+  for (double val : {0.0, 0.1, -2.5, 1e300, -3e-300, 4.9e-324}) {
+    EXPECT_EQ(BigRational::FromDouble(val).ToDouble(), val);
+  }
+  EXPECT_EQ(BigRational::FromDouble(0.375).ToString(), "3/8");
+  EXPECT_EQ(BigRational::FromDouble(-1024.0).ToString(), "-1024");
+}
+
+TEST(BigFloatTests, Rounding) {
+  // Ties go to even
+  EXPECT_EQ(BigFloat(BigInt(11), 3), BigFloat(12, 0, 64));
+  EXPECT_EQ(BigFloat(BigInt(13), 3), BigFloat(12, 0, 64));
+  EXPECT_EQ(BigFloat(BigInt(-9), 3), BigFloat(-8, 0, 64));
+  EXPECT_EQ(BigFloat(BigInt(255), 4), BigFloat(1, 8, 64));
+
+  for (double val : {0.1, -2.5, 1e300, -3e-300, 4.9e-324}) {
+    EXPECT_EQ(BigFloat::FromDouble(val).ToDouble(), val);
+  }
+
+  BigFloat third = BigFloat(1, 53) / BigFloat(3, 53);
+  EXPECT_EQ(third.ToDouble(), 1.0 / 3);
+  EXPECT_EQ(BigFloat::FromString("0.1", 53)->ToDouble(), 0.1);
+  EXPECT_EQ(BigFloat::FromString("-12.5e-3", 53)->ToDouble(), -0.0125);
+  EXPECT_EQ(BigFloat::FromRational(BigRational(-2, 7), 53).ToDouble(),
+            -2.0 / 7);
+  EXPECT_FALSE(BigFloat::FromString("1e").has_value());
+  EXPECT_FALSE(BigFloat::FromString("1.5.e3").has_value());
+
+  // Exponents too long to apply exactly still round correctly
+  BigInt ten_pow = 1;
+  for (int i = 0; i < 401; ++i) {
+    ten_pow *= 10;
+  }
+  EXPECT_EQ(BigFloat::FromString("1.5e-400", 64),
+            BigFloat::FromRational(BigRational(15, ten_pow), 64));
+  EXPECT_EQ(BigFloat::FromString("-3e400", 64),
+            BigFloat::FromRational(BigRational(-3 * ten_pow / 10), 64));
+  EXPECT_EQ(BigFloat::FromString("1e-300", 53)->ToDouble(), 1e-300);
+  EXPECT_EQ(BigFloat::FromString("-7e300", 53)->ToDouble(), -7e300);
+
+  auto tiny = BigFloat::FromString("1e-99999999999", 64);
+  ASSERT_TRUE(tiny.has_value());
+  EXPECT_EQ(tiny->Exponent() +
+                static_cast<int64_t>(tiny->Mantissa().BitLength()),
+            -332192809485);
+  EXPECT_EQ(tiny->ToString(10), "1.000000000e-99999999999");
+  EXPECT_EQ(BigFloat::FromString("-3e99999999999", 64)->ToString(10),
+            "-3.000000000e99999999999");
+  EXPECT_EQ(BigFloat::FromString("1.5e-400", 64)->ToString(10),
+            "1.500000000e-400");
+  EXPECT_TRUE(BigFloat::FromString("0e-99999999999")->IsZero());
+  EXPECT_FALSE(BigFloat::FromString("1e-9223372036854775808").has_value());
+  EXPECT_FALSE(BigFloat::FromString("1e1000000000000000001").has_value());
+}
+
+TEST(BigFloatTests, Arithmetic) {
+  EXPECT_EQ((BigFloat(1, 53) + BigFloat(2, 53)).ToDouble(), 3.0);
+  EXPECT_EQ((BigFloat::FromDouble(0.1, 53) + BigFloat::FromDouble(0.2, 53))
+                .ToDouble(),
+            0.1 + 0.2);
+  EXPECT_EQ((BigFloat::FromDouble(1.1, 53) * BigFloat::FromDouble(1.1, 53))
+                .ToDouble(),
+            1.1 * 1.1);
+  EXPECT_EQ(Sqrt(BigFloat(2, 53)).ToDouble(), std::sqrt(2.0));
+  EXPECT_TRUE((BigFloat(5, 64) - BigFloat(5, 64)).IsZero());
+
+  // A tiny operand only decides the rounding direction
+  BigFloat one(1, 10);
+  EXPECT_EQ(one + BigFloat(1, -1000, 10), one);
+  EXPECT_EQ(one - BigFloat(1, -1000, 10), one);
+  BigFloat tie = one + BigFloat(1, -10, 10);
+  EXPECT_EQ(tie, one);
+  BigFloat above_tie((BigInt(1) << 990) + 1, -1000, 1000);
+  EXPECT_EQ(one + above_tie, BigFloat(513, -9, 10));
+
+  BigFloat huge(BigInt(1) << 20000, 20000);
+  BigFloat quot = huge / BigFloat(Factorial(1000), 20000);
+  EXPECT_EQ(quot * BigFloat(Factorial(1000), 30000) <=> huge,
+            std::strong_ordering::equal);
+
+  EXPECT_LT(BigFloat(-3, 10), BigFloat(1, -5, 10));
+  EXPECT_GT(BigFloat(3, 1, 10), BigFloat(5, 0, 10));
+}
+
+TEST(BigFloatTests, Constants) {
+  EXPECT_EQ(ConstPi(200).ToString(50),
+            "3.1415926535897932384626433832795028841971693993751e0");
+  EXPECT_EQ(ConstE(200).ToString(50),
+            "2.7182818284590452353602874713526624977572470937000e0");
+  EXPECT_EQ(ConstLn2(200).ToString(50),
+            "6.9314718055994530941723212145817656807550013436026e-1");
+  EXPECT_EQ(ConstPi(53).ToDouble(), M_PI);
+
+  std::string digits = ConstPi(3400).ToString(1000);
+  EXPECT_EQ(digits.substr(digits.size() - 11), "216420199e0");
+}
+
+TEST(BigFloatTests, Transcendental) {
+  EXPECT_EQ(Exp(BigFloat(0, 0, 64)), BigFloat(1, 0, 64));
+  EXPECT_EQ(Log(BigFloat(1, 0, 64)), BigFloat(0, 0, 64));
+  EXPECT_EQ(Exp(BigFloat(1, 200)).ToString(50), ConstE(200).ToString(50));
+  EXPECT_EQ(Log(BigFloat(2, 200)).ToString(50), ConstLn2(200).ToString(50));
+
+  EXPECT_EQ(Exp(BigFloat::FromString("-50.25", 200).value()).ToString(30),
+            "1.50211189194315225393328642131e-22");
+  EXPECT_EQ(Log(BigFloat::FromString("1e-30", 200).value()).ToString(30),
+            "-6.90775527898213705205397436405e1");
+
+  auto val = BigFloat::FromString("3.7", 300).value();
+  EXPECT_EQ(Log(Exp(val)).ToString(80), val.ToString(80));
+
+  // Tiny arguments round to 1, huge ones saturate
+  EXPECT_EQ(Exp(BigFloat(-1, -100, 64)), BigFloat(1, 0, 64));
+  BigFloat big(1, 61, 64);
+  EXPECT_EQ(Log(Exp(big)).ToString(15), big.ToString(15));
+  EXPECT_EQ(Exp(BigFloat(1, 62, 64)), BigFloat(1, int64_t{1} << 62, 64));
+  EXPECT_EQ(Exp(BigFloat(1, 1000, 64)), BigFloat(1, int64_t{1} << 62, 64));
+  EXPECT_TRUE(Exp(BigFloat(-1, 62, 64)).IsZero());
+  EXPECT_TRUE(Exp(BigFloat(-1, 1000, 64)).IsZero());
+}
+
+TEST(RandomTests, Bits) {
+  std::mt19937_64 rng(42);
+  EXPECT_EQ(RandomBits(0, rng), 0);
+
+  bool top_seen = false;
+  for (uint64_t bits : {1, 31, 32, 33, 64, 65, 1000}) {
+    for (int i = 0; i < 64; ++i) {
+      BigInt val = RandomBits(bits, rng);
+      EXPECT_GE(val, 0);
+      EXPECT_LE(val.BitLength(), bits);
+      top_seen = top_seen || val.BitLength() == bits;
+    }
+  }
+  EXPECT_TRUE(top_seen);
+
+  // Same seed, same numbers, with any generator
+  std::mt19937 first(7);
+  std::mt19937 second(7);
+  EXPECT_EQ(RandomBits(500, first), RandomBits(500, second));
+  std::minstd_rand narrow(7);
+  EXPECT_LE(RandomBits(100, narrow).BitLength(), 100);
+}
+
+TEST(RandomTests, Below) {
+  std::mt19937_64 rng(42);
+  std::array<int, 6> counts{};
+  for (int i = 0; i < 6000; ++i) {
+    auto val = RandomBelow(BigInt(6), rng).ToInt64();
+    ASSERT_TRUE(val && *val >= 0 && *val < 6);
+    ++counts[*val];
+  }
+  for (int count : counts) {
+    EXPECT_NEAR(count, 1000, 150);
+  }
+
+  // Top limb equal to the bound's in most draws
+  BigInt bound = (BigInt(1) << 100) + 1;
+  std::minstd_rand narrow(3);
+  for (int i = 0; i < 200; ++i) {
+    BigInt val = RandomBelow(bound, rng);
+    EXPECT_GE(val, 0);
+    EXPECT_LT(val, bound);
+    EXPECT_LT(RandomBelow(bound, narrow), bound);
+  }
+  EXPECT_EQ(RandomBelow(BigInt(1), rng), 0);
+}
+
+TEST(RandomTests, Batch) {
+  std::mt19937_64 rng(42);
+  std::vector<BigInt> vals(100);
+  RandomBits(vals, 2000, rng);
+  std::vector<std::size_t> capacity;
+  for (const auto& val : vals) {
+    capacity.push_back(val.Capacity());
+  }
+
+  BigInt bound = "123456789012345678901234567890"_bi;
+  RandomBelow(vals, bound, rng);
+  for (std::size_t i = 0; i < vals.size(); ++i) {
+    EXPECT_LT(vals[i], bound);
+    EXPECT_EQ(vals[i].Capacity(), capacity[i]);
+  }
+  EXPECT_NE(vals[0], vals[1]);
+}
+
+namespace {
+// The pid keeps concurrent test runs off each other's files
+std::string TempPath(const std::string& name) {
+  std::string file = "bigint_" + std::to_string(getpid()) + "_" + name;
+  return (std::filesystem::temp_directory_path() / file).string();
+}
+};  // namespace
+
+TEST(FileTests, SaveLoad) {
+  std::mt19937_64 rng(1);
+  for (BigInt val : {BigInt(0), BigInt(-5), -RandomBits(5000, rng)}) {
+    std::string path = TempPath("save");
+    {
+      auto file = BigIntFile::Save(path, val);
+      ASSERT_TRUE(file.has_value());
+      EXPECT_EQ(file->LimbCount(), val.LimbCount());
+    }
+    auto file = BigIntFile::Open(path);
+    ASSERT_TRUE(file.has_value());
+    EXPECT_EQ(file->Load(), val);
+    std::filesystem::remove(path);
+  }
+  EXPECT_FALSE(BigIntFile::Open(TempPath("missing")).has_value());
+}
+
+TEST(FileTests, Streaming) {
+  std::mt19937_64 rng(2);
+  BigInt big = RandomBits(3000, rng);
+  BigInt small = RandomBits(1000, rng);
+  std::string lhs_path = TempPath("lhs");
+  std::string rhs_path = TempPath("rhs");
+  std::string out_path = TempPath("out");
+
+  for (auto [lhs, rhs] : {std::pair{big, small}, std::pair{-big, small},
+                          std::pair{small, -big}, std::pair{big, big},
+                          std::pair{BigInt(0), -small}}) {
+    auto lhs_file = BigIntFile::Save(lhs_path, lhs);
+    auto rhs_file = BigIntFile::Save(rhs_path, rhs);
+    EXPECT_EQ(Compare(*lhs_file, *rhs_file), lhs <=> rhs);
+    EXPECT_EQ(Add(out_path, *lhs_file, *rhs_file)->Load(), lhs + rhs);
+    EXPECT_EQ(Sub(out_path, *lhs_file, *rhs_file)->Load(), lhs - rhs);
+  }
+
+  // An operand as the output is refused and stays intact
+  auto lhs_file = BigIntFile::Save(lhs_path, big);
+  auto rhs_file = BigIntFile::Save(rhs_path, small);
+  EXPECT_FALSE(Add(lhs_path, *lhs_file, *rhs_file).has_value());
+  EXPECT_FALSE(Sub(rhs_path, *lhs_file, *rhs_file).has_value());
+  EXPECT_FALSE(Mul(rhs_path, *lhs_file, *rhs_file, 0).has_value());
+  EXPECT_EQ(lhs_file->Load(), big);
+  EXPECT_EQ(rhs_file->Load(), small);
+
+  for (const auto& path : {lhs_path, rhs_path, out_path}) {
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(FileTests, MulResume) {
+  std::mt19937_64 rng(3);
+  BigInt lhs = RandomBits(64 * 32 * 9 + 5, rng);
+  BigInt rhs = -RandomBits(64 * 32 * 5, rng);
+  std::string lhs_path = TempPath("mul_lhs");
+  std::string rhs_path = TempPath("mul_rhs");
+  std::string out_path = TempPath("mul_out");
+  auto lhs_file = BigIntFile::Save(lhs_path, lhs);
+  auto rhs_file = BigIntFile::Save(rhs_path, rhs);
+
+  // Smallest blocks, many windows
+  auto whole = Mul(out_path, *lhs_file, *rhs_file, 0);
+  ASSERT_TRUE(whole.has_value());
+  EXPECT_EQ(whole->Load(), lhs * rhs);
+  EXPECT_FALSE(std::filesystem::exists(out_path + ".ckpt"));
+
+  // Stopped halfway, then resumed from the checkpoint
+  uint64_t windows = 0;
+  auto stop = [&](uint64_t done, uint64_t total) {
+    windows = total;
+    return done < total / 2;
+  };
+  EXPECT_FALSE(Mul(out_path, *lhs_file, *rhs_file, 0, stop).has_value());
+  EXPECT_TRUE(std::filesystem::exists(out_path + ".ckpt"));
+
+  uint64_t resumed_from = 0;
+  auto first_step = [&](uint64_t done, uint64_t) {
+    resumed_from = (resumed_from == 0) ? done : resumed_from;
+    return true;
+  };
+  auto resumed = Mul(out_path, *lhs_file, *rhs_file, 0, first_step);
+  ASSERT_TRUE(resumed.has_value());
+  EXPECT_EQ(resumed->Load(), lhs * rhs);
+  EXPECT_EQ(resumed_from, windows / 2 + 1);
+
+  // Operands of the same size after an interrupted run start over
+  EXPECT_FALSE(Mul(out_path, *lhs_file, *rhs_file, 0, stop).has_value());
+  BigInt other = RandomBits(64 * 32 * 5, rng);
+  std::string other_path = TempPath("mul_other");
+  auto other_file = BigIntFile::Save(other_path, other);
+  resumed_from = 0;
+  auto fresh = Mul(out_path, *lhs_file, *other_file, 0, first_step);
+  ASSERT_TRUE(fresh.has_value());
+  EXPECT_EQ(fresh->Load(), lhs * other);
+  EXPECT_EQ(resumed_from, 1);
+  EXPECT_FALSE(std::filesystem::exists(out_path + ".ckpt"));
+
+  for (const auto& path : {lhs_path, rhs_path, other_path, out_path}) {
+    std::filesystem::remove(path);
+  }
+}
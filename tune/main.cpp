@@ -0,0 +1,167 @@
+// Finds algorithm crossover points on this host and writes them out both
+// as a header with compile-time defaults (drop it next to
+// big_integer_tuning.hpp and rebuild) and as a runtime config (point
+// BIGINT_TUNE_CONFIG at it or pass it to LoadThresholds).
+//
+// Usage: bigint_tune [header_path] [config_path]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "big_integer.hpp"
+#include "big_integer_random.hpp"
+#include "big_integer_tuning.hpp"
+
+namespace {
+constexpr std::size_t kMinLimbs = 8;
+constexpr std::size_t kMaxLimbs = 512;
+// Newton division only pays off with operands of a few thousand limbs
+constexpr std::size_t kMaxDivLimbs = 4096;
+constexpr int kTrials = 5;
+constexpr auto kMinTrialTime = std::chrono::milliseconds(2);
+
+// Crossover is accepted once the next tier wins this many sizes in a row
+constexpr int kStableWins = 3;
+
+// Top bit set to keep the exact limb count
+BigInt RandomBigInt(std::size_t limbs, std::mt19937_64& rng) {
+  uint64_t bits = limbs * 32;
+  return RandomBits(bits - 1, rng) + (BigInt(1) << (bits - 1));
+}
+
+// Best of trials time of one op(), in nanoseconds
+template <typename Op>
+double TimeOp(Op& op) {
+  using Clock = std::chrono::steady_clock;
+  double best = 0;
+
+  for (int trial = 0; trial < kTrials; ++trial) {
+    std::size_t reps = 0;
+    auto start = Clock::now();
+
+    do {
+      op();
+      ++reps;
+    } while (Clock::now() - start < kMinTrialTime);
+
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    double per_op = elapsed.count() / static_cast<double>(reps);
+    best = (trial == 0) ? per_op : std::min(best, per_op);
+  }
+
+  return best;
+}
+
+void SetThreshold(std::size_t BigIntThresholds::*field, std::size_t value) {
+  BigIntThresholds thresholds = GetThresholds();
+  thresholds.*field = value;
+  SetThresholds(thresholds);
+}
+
+// Smallest size up to max_limbs where one level of the next tier (the
+// current one below) beats the current tier. make_op(limbs) gives the
+// operation to time. Without a stable win in range the threshold keeps its
+// value from before the search.
+template <typename MakeOp>
+std::size_t FindCrossover(const char* name,
+                          std::size_t BigIntThresholds::*field,
+                          std::size_t max_limbs, const MakeOp& make_op) {
+  std::size_t previous = GetThresholds().*field;
+  int wins = 0;
+  std::size_t first_win = max_limbs;
+
+  for (std::size_t limbs = kMinLimbs; limbs <= max_limbs;
+       limbs += std::max<std::size_t>(limbs / 8, 1)) {
+    auto op = make_op(limbs);
+
+    SetThreshold(field, SIZE_MAX);
+    double current = TimeOp(op);
+    SetThreshold(field, limbs);
+    double next = TimeOp(op);
+
+    std::cerr << name << ' ' << limbs << " limbs: " << current << " ns, next "
+              << next << " ns\n";
+
+    first_win = (wins == 0) ? limbs : first_win;
+    wins = (next < current) ? wins + 1 : 0;
+    if (wins == kStableWins) {
+      SetThreshold(field, first_win);
+      return first_win;
+    }
+  }
+
+  std::cerr << name << ": no crossover up to " << max_limbs
+            << " limbs, keeping " << previous << '\n';
+  SetThreshold(field, previous);
+  return previous;
+}
+
+void WriteHeader(std::ostream& out, const BigIntThresholds& thresholds) {
+  out << "// Generated by bigint_tune, do not edit.\n"
+      << "#pragma once\n\n"
+      << "#define BIGINT_KARATSUBA_MUL_THRESHOLD " << thresholds.karatsuba_mul
+      << '\n'
+      << "#define BIGINT_KARATSUBA_SQR_THRESHOLD " << thresholds.karatsuba_sqr
+      << '\n'
+      << "#define BIGINT_RADIX_CONVERSION_THRESHOLD "
+      << thresholds.radix_conversion << '\n'
+      << "#define BIGINT_NEWTON_DIV_THRESHOLD " << thresholds.newton_div
+      << '\n';
+}
+};  // namespace
+
+int main(int argc, char** argv) {
+  std::string header_path = (argc > 1) ? argv[1] : "big_integer_tuned.hpp";
+  std::string config_path = (argc > 2) ? argv[2] : "bigint_tune.cfg";
+  std::mt19937_64 rng(std::random_device{}());
+
+  // Each search leaves its result set, later tiers are timed on top of it
+  FindCrossover("mul", &BigIntThresholds::karatsuba_mul, kMaxLimbs,
+                [&](std::size_t limbs) {
+                  BigInt lhs = RandomBigInt(limbs, rng);
+                  BigInt rhs = RandomBigInt(limbs, rng);
+                  return [lhs, rhs, dst = BigInt()]() mutable {
+                    Mul(dst, lhs, rhs);
+                  };
+                });
+  FindCrossover("sqr", &BigIntThresholds::karatsuba_sqr, kMaxLimbs,
+                [&](std::size_t limbs) {
+                  BigInt val = RandomBigInt(limbs, rng);
+                  return [val, dst = BigInt()]() mutable {
+                    Mul(dst, val, val);
+                  };
+                });
+  FindCrossover("radix", &BigIntThresholds::radix_conversion, kMaxLimbs,
+                [&](std::size_t limbs) {
+                  BigInt val = RandomBigInt(limbs, rng);
+                  return [val] { BigInt::FromString(val.ToString()); };
+                });
+  FindCrossover("div", &BigIntThresholds::newton_div, kMaxDivLimbs,
+                [&](std::size_t limbs) {
+                  BigInt lhs = RandomBigInt(2 * limbs, rng);
+                  BigInt rhs = RandomBigInt(limbs, rng);
+                  return [lhs, rhs, quot = BigInt(), rem = BigInt()]() mutable {
+                    DivMod(quot, rem, lhs, rhs);
+                  };
+                });
+
+  BigIntThresholds tuned = GetThresholds();
+
+  std::ofstream header(header_path);
+  std::ofstream config(config_path);
+  WriteHeader(header, tuned);
+  SaveThresholds(config, tuned);
+  SaveThresholds(std::cout, tuned);
+
+  if (!header || !config) {
+    std::cerr << "bigint_tune: failed to write output files\n";
+    return 1;
+  }
+
+  return 0;
+}